@@ -43,7 +43,7 @@ int main(){
     
     p_image = _load_image("samples/template.psd");
     p_mesh = _load_mesh("samples/fish.glb");
-    p_mesh->self.transform.position[2] = -200.0f;
+    bvr_set_actor_position(&p_mesh->self, (vec3){0.0f, 0.0f, -200.0f});
 
     /* main loop */
     while (1)
@@ -93,7 +93,7 @@ int main(){
                 because bvr_key_down returns a bool, if a key is down it will return 1.
             */
             vec2 inputs = {0.0f, 0.0f};
-            float speed = 1.0f;
+            float speed = 60.0f; /* units per second */
 
             inputs[0] += bvr_axis_down(&book.window.inputs.axis.horizontal);
             inputs[1] += bvr_axis_down(&book.window.inputs.axis.vertical);
@@ -112,8 +112,8 @@ int main(){
         /* update collisions and physics */
         bvr_update(&book);
 
-        /* draw player */
-        bvr_draw_actor(&player->self, BVR_DRAWMODE_TRIANGLES);
+        /* draw page's visible actors */
+        bvr_draw_page(&book);
 
         bvr_flush(&book);
 
@@ -8,11 +8,27 @@
 
 #include <stdio.h>
 
+struct bvr_message_s;
+
 /*
     Does not destroy the actor when freeing the page
 */
 #define BVR_ACTOR_NOT_FREE 0x00001
 
+/*
+    Actor's callback only reads and writes the actor itself (its transform and its components),
+    so it can run on worker threads alongside other callbacks. 
+    It must not allocate, free or query other actors.
+    `bvr_get_actor_matrix` returns the matrix built by the last transform batch.
+*/
+#define BVR_ACTOR_PARALLEL_CALLBACK 0x00002
+
+/*
+    Actor is drawn during the transparent pass, after opaque actors and from back to front.
+    Layer actors, texture actors and y-sorted actors are always transparent.
+*/
+#define BVR_ACTOR_TRANSPARENT 0x00004
+
 /*
     This actor can only block object; this means that this actor shall not 
     move.
@@ -36,7 +52,8 @@
 #define BVR_DYNACTOR_TRIANGULATE_COLLIDER_FROM_VERTICES 0x00080
 
 /*
-    Define if this actor should link its y position to its sorting method
+    Define if this actor should link its y position to its sorting method,
+    higher actors are drawn first.
 */
 #define BVR_DYNACTOR_Y_SORTED   0x00100
 
@@ -55,13 +72,16 @@ typedef enum bvr_actor_type_e {
     BVR_LANDSCAPE_ACTOR
 } bvr_actor_type_t;
 
+#define BVR_ACTOR_TYPE_COUNT (BVR_LANDSCAPE_ACTOR + 1)
+
 /*
     Each actor based struct must start by 
     an actor struct.
 */
 
 struct bvr_actor_s {
-    bvr_string_t name;
+    bvr_atom_t name;
+    bvr_atom_t tag;
     bvr_actor_type_t type;
     bvr_uuid_t id;
 
@@ -73,6 +93,20 @@ struct bvr_actor_s {
     struct bvr_transform_s transform;
 
     void(*callback)(struct bvr_actor_s* self);
+
+    /* called for each message sent to this actor or to one of its channels, can be NULL */
+    void(*receive)(struct bvr_actor_s* self, const struct bvr_message_s* message);
+
+    /* page's actor handle */
+    bvr_handle_t handle;
+
+    /* index inside page's transform streams, BVR_INVALID_INDEX if the actor has no page */
+    uint32 transform_index;
+
+    /* hierarchy links, set by bvr_set_actor_parent. NULL for root actors */
+    struct bvr_actor_s* parent;
+    struct bvr_actor_s* first_child;
+    struct bvr_actor_s* next_sibling;
 };
 
 /**
@@ -152,8 +186,21 @@ struct bvr_tile_s {
 void bvr_create_actor(struct bvr_actor_s* actor, const char* name, int flags, bvr_actor_event_t event);
 void bvr_destroy_actor(struct bvr_actor_s* actor);
 
+/*
+    Call actor's callback and add its draw commands to the pipeline.
+*/
 void bvr_draw_actor(struct bvr_actor_s* actor, int drawmode);
 
+/*
+    Add actor's draw commands to the pipeline, without calling its callback.
+*/
+void bvr_submit_actor(struct bvr_actor_s* actor, int drawmode);
+
+/*
+    Get actor's draw key for a command using `shader`, `texture` and `mesh` (array buffer).
+*/
+uint64 bvr_actor_draw_key(struct bvr_actor_s* actor, const uint32 shader, const uint32 texture, const uint32 mesh);
+
 BVR_H_FUNC int bvr_is_actor_null(struct bvr_actor_s* actor){
     return actor == NULL || actor->type == BVR_NULL_ACTOR;
 }
\ No newline at end of file
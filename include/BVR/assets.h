@@ -44,8 +44,18 @@ bvr_uuid_t* bvr_register_asset(const char* path, char open_mode);
 */
 bvr_uuid_t* bvr_find_asset(const char* path, bvr_asset_t* asset);
 
+/*
+    Same as `bvr_find_asset`, but uses an interned path.
+*/
+bvr_uuid_t* bvr_find_asset_atom(const bvr_atom_t path, bvr_asset_t* asset);
+
 int bvr_find_asset_uuid(const bvr_uuid_t uuid, bvr_asset_t* asset);
 
+/*
+    Remove all assets from the asset list
+*/
+void bvr_clear_assets(void);
+
 /*
     Open a file stream to a game asset
 */
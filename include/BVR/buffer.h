@@ -10,29 +10,32 @@
     #define BVR_BUFFER_SIZE 1024
 #endif
 
-#ifndef BVR_POOL_SIZE
-    #define BVR_POOL_SIZE 2048
+#ifndef BVR_MEMSTREAM_PAGE_SIZE
+    #define BVR_MEMSTREAM_PAGE_SIZE 4096
+#endif
+
+#ifndef BVR_MEMSTREAM_MAX_PAGE_SIZE
+    #define BVR_MEMSTREAM_MAX_PAGE_SIZE 4194304
+#endif
+
+#ifndef BVR_ARENA_ALIGNMENT
+    #define BVR_ARENA_ALIGNMENT 16
 #endif
 
 #define SEEK_NEXT 3
 
 /*
-    This macro creates a for loop that interates through a pool.
-    It will define each `_v` as the current used value.
+    Index value used to tag invalid handles and empty free lists.
 */
+#define BVR_INVALID_INDEX 0xFFFFFFFF
 
-// GCC specific macro
-#ifdef __GNUC__
-    #define BVR_POOL_FOR_EACH(_v, _pool) for (struct bvr_pool_block_u* b = _pool.blocks; b->next; b++)\
-                                            if (b->data && (void*)memcpy(&_v, b->data, _pool.elemsize) != NULL)
-    // Clang specific macro
-#elif defined(__clang__) || defined(_MSC_VER)
-    #define BVR_POOL_FOR_EACH(_v, _pool) for (struct bvr_pool_block_u* b = _pool.blocks; b->next; b++)\
-                                            if (b->data && (void*)memcpy(&_v, b->data, _pool.elemsize) != NULL)
-#else
-    #define BVR_POOL_FOR_EACH(_v, _pool) for (struct bvr_pool_block_u* b = _pool.blocks; b->next; b++)\
-                                            if (b->data && (void*)memcpy(&_v, b->data, _pool.elemsize) != NULL)                               
-#endif
+/*
+    This macro creates a for loop that interates through a slot map's dense array.
+    It will define each `_v` as the current used value.
+    Elements are tightly packed, so that the loop never visits freed slots.
+*/
+#define BVR_SLOTMAP_FOR_EACH(_v, _map) for (uint32 bvri_it = 0; bvri_it < (_map).count && \
+                                            (void*)memcpy(&_v, (_map).data + (uint64)bvri_it * (_map).elemsize, (_map).elemsize) != NULL; bvri_it++)
 
 /*
     Generic data pointer
@@ -43,14 +46,112 @@ struct __attribute__((packed)) bvr_buffer_s {
     unsigned int elemsize;
 };
 
+/*
+    Memory stream's page header, page's data directly follows the header.
+*/
+struct bvr_memstream_page_s {
+    struct bvr_memstream_page_s* next;
+
+    // page's capacity
+    uint64 size;
+
+    // number of written bytes
+    uint64 used;
+};
+
+/*
+    Memory stream made of linked pages.
+    Pages are never moved nor reallocated, so that 
+    any address inside the stream stays valid until the stream is destroyed.
+*/
 typedef struct bvr_memstream_s {
-    void* data;
-    unsigned long long size;
+    struct bvr_memstream_page_s* pages;
+    struct bvr_memstream_page_s* last;
 
+    // current page and cursor's address inside this page
+    struct bvr_memstream_page_s* page;
     char* cursor;
-    char* next;
+
+    // cursor's logical position
+    uint64 position;
+
+    // total of written bytes
+    uint64 length;
+
+    // total capacity
+    uint64 size;
 } bvr_memstream_t;
 
+/*
+    Hash map entry, an entry is empty when its value is NULL.
+*/
+struct bvr_hashmap_entry_s {
+    uint64 key;
+    void* value;
+};
+
+/*
+    Value of a removed entry.
+*/
+#define BVR_HASHMAP_TOMBSTONE ((void*)1)
+
+/*
+    Open-addressing (linear probing) hash map from 64-bit keys to non-NULL pointers.
+    Several values can share the same key.
+*/
+typedef struct bvr_hashmap_s {
+    struct bvr_hashmap_entry_s* entries;
+
+    uint32 count;
+    uint32 tombstones;
+    uint32 capacity;
+} bvr_hashmap_t;
+
+/*
+    Interned string handle, `BVR_NULL_ATOM` is never a valid string.
+*/
+typedef uint32 bvr_atom_t;
+
+#define BVR_NULL_ATOM 0
+
+/*
+    Overflow block of an arena. 
+    It is only used when the arena's budget is exceeded.
+*/
+struct bvr_arena_block_s {
+    struct bvr_arena_block_s* next;
+    uint64 size;
+    uint64 offset;
+};
+
+/*
+    Linear bump allocator.
+    Allocated memory is never freed individually, the whole arena 
+    is released at once with `bvr_arena_reset`.
+*/
+typedef struct bvr_arena_s {
+    char* data;
+    uint64 size;
+    uint64 offset;
+
+    // bytes used since the last reset (overflow included)
+    uint64 used;
+
+    // highest number of bytes used between two resets
+    uint64 peak;
+
+    struct bvr_arena_block_s* overflow;
+} bvr_arena_t;
+
+/*
+    Double-buffered arena.
+    Memory allocated during a frame stays valid until the end of the next frame.
+*/
+typedef struct bvr_frame_arena_s {
+    bvr_arena_t arenas[2];
+    uint8 current;
+} bvr_frame_arena_t;
+
 /*
     pascal typed string
 */
@@ -59,41 +160,217 @@ typedef __attribute__ ((packed)) struct bvr_string_s  {
     char* string;
 } bvr_string_t;
 
-__attribute__ ((packed)) struct bvr_pool_block_u {
-    void* data;
-    struct bvr_pool_block_u* next;
+/*
+    Generational handle referencing a slot map element.
+    A handle becomes stale as soon as its element is freed, 
+    even if the slot is reused by another element.
+*/
+typedef struct bvr_handle_s {
+    uint32 index;
+    uint32 generation;
+} bvr_handle_t;
+
+/*
+    Indirection slot of a slot map.
+    When the slot is used, `dense` is the element's position in the dense array,
+    otherwise it is the index of the next free slot.
+*/
+struct bvr_slot_s {
+    uint32 dense;
+    uint32 generation;
 };
 
-typedef struct bvr_pool_s {
+/*
+    Packed array of elements addressed by generational handles.
+    Allocating and freeing are O(1), freeing moves the last element
+    into the freed place so that the dense array stays packed.
+    The slot map grows when it is full, growing moves elements but handles stay valid.
+*/
+typedef struct bvr_slotmap_s {
     char* data;
-    char* avail;
 
-    struct bvr_pool_block_u* blocks;
-    struct bvr_pool_block_u* next_block;
+    struct bvr_slot_s* slots;
+    uint32* owners;
 
-    uint32 size;
+    uint32 free_slot;
     uint32 elemsize;
     uint32 count;
     uint32 capacity;
-} bvr_pool_t;
+
+    // highest number of elements stored at the same time
+    uint32 peak;
+} bvr_slotmap_t;
 
 /*
-    Create a new memory stream which is a long pre-allocated memory space where things can be written.
+    Create a new memory stream which is a list of pre-allocated memory pages where things can be written.
     Work like a FILE* but in-memory :D
+    `size` is the first page's size, if `size` is 0 the first page is created on the first write.
 */
 void bvr_create_memstream(bvr_memstream_t* stream, const uint64 size);
 
+/*
+    Write data at cursor's position and move the cursor forward.
+    Writing at the end of the stream (see SEEK_NEXT) always writes a contiguous block, 
+    if the last page is too small a new page is appended.
+    If `data` is NULL, memory is just reserved.
+    Returns a pointer to the written block. 
+*/
 char* bvr_memstream_write(bvr_memstream_t* stream, const void* data, const uint64 size);
+
+/*
+    Reserve `size` zeroed bytes aligned on `alignment` bytes (must be a power of two) 
+    at the end of the stream. Cursor is moved to the end of the stream.
+    Returns a pointer to the reserved block.
+*/
+char* bvr_memstream_alloc(bvr_memstream_t* stream, const uint64 size, const uint64 alignment);
+
+/*
+    Copy data at cursor's position into `dest` and move the cursor forward.
+    Returns the new cursor.
+*/
 char* bvr_memstream_read(bvr_memstream_t* stream, void* dest, const uint64 size);
+
+/*
+    Returns a pointer to the cursor if the next `size` bytes are contiguous, 
+    returns NULL otherwise. Cursor is not moved.
+*/
+char* bvr_memstream_peek(bvr_memstream_t* stream, const uint64 size);
+
+/*
+    Move the cursor. 
+    SEEK_SET and SEEK_END are relative to the beginning and the end of the written data,
+    SEEK_CUR moves forward and SEEK_NEXT goes to the end of the written data.
+*/
 char* bvr_memstream_seek(bvr_memstream_t* stream, uint64 position, int mode);
+
+/*
+    Remove all written data, pages are kept.
+*/
 void bvr_memstream_clear(bvr_memstream_t* stream);
 
+/*
+    Write every page's content into a file.
+    Returns the number of written bytes.
+*/
+uint64 bvr_memstream_fwrite(bvr_memstream_t* stream, FILE* file);
+
 BVR_H_FUNC int bvr_memstream_eof(bvr_memstream_t* stream){
-    return stream->cursor - (char*)stream->data >= stream->size;
+    return stream->position >= stream->length;
 }
 
 void bvr_destroy_memstream(bvr_memstream_t* stream);
 
+/*
+    Create a new hash map, `count` is rounded to the next power of two.
+    If `count` is 0, entries are allocated on the first insertion.
+*/
+void bvr_create_hashmap(bvr_hashmap_t* map, const uint64 count);
+
+/*
+    Add a new key-value pair, keys can be duplicated.
+    Returns BVR_FALSE if value is NULL.
+*/
+int bvr_hashmap_insert(bvr_hashmap_t* map, const uint64 key, void* value);
+
+/*
+    Get the first value stored with `key`.
+    Returns NULL if there is no such value.
+*/
+void* bvr_hashmap_find(bvr_hashmap_t* map, const uint64 key);
+
+/*
+    Iterate through all values stored with `key`.
+    `iterator` must be set to 0 before the first call.
+    Returns NULL when there is no more value.
+*/
+void* bvr_hashmap_next(bvr_hashmap_t* map, const uint64 key, uint32* iterator);
+
+/*
+    Remove a key-value pair, if `value` is NULL the first value stored with `key` is removed.
+    Returns BVR_FALSE if the pair does not exist.
+*/
+int bvr_hashmap_remove(bvr_hashmap_t* map, const uint64 key, const void* value);
+
+void bvr_hashmap_clear(bvr_hashmap_t* map);
+void bvr_destroy_hashmap(bvr_hashmap_t* map);
+
+/*
+    Get the atom of a string, the string is copied inside the global string table 
+    if it was not already interned.
+*/
+bvr_atom_t bvr_intern(const char* string);
+
+/*
+    Same as `bvr_intern`, but only the first `length` chars are used.
+*/
+bvr_atom_t bvr_intern_n(const char* string, const uint64 length);
+
+/*
+    Get the atom of an already interned string.
+    Returns BVR_NULL_ATOM if the string has never been interned.
+*/
+bvr_atom_t bvr_find_atom(const char* string);
+
+/*
+    Get atom's string.
+    The pointer stays valid until the string table is destroyed.
+    Returns NULL for BVR_NULL_ATOM.
+*/
+const char* bvr_atom_string(const bvr_atom_t atom);
+
+/*
+    Get atom's string length (without the null character).
+*/
+uint32 bvr_atom_length(const bvr_atom_t atom);
+
+/*
+    Free the global string table, every atom becomes invalid.
+*/
+void bvr_destroy_string_table(void);
+
+/*
+    Create a new arena with a budget of `size` bytes.
+*/
+void bvr_create_arena(bvr_arena_t* arena, const uint64 size);
+
+/*
+    Get `size` bytes of memory aligned on `alignment` bytes (must be a power of two).
+    If the budget is exceeded, an overflow block is allocated and the arena 
+    will grow to fit its peak usage on the next reset.
+*/
+void* bvr_arena_alloc(bvr_arena_t* arena, const uint64 size, const uint64 alignment);
+
+/*
+    Release every allocation made since the last reset.
+*/
+void bvr_arena_reset(bvr_arena_t* arena);
+
+void bvr_destroy_arena(bvr_arena_t* arena);
+
+void bvr_create_frame_arena(bvr_frame_arena_t* arena, const uint64 size);
+
+/*
+    Swap frame arenas and reset the new current one.
+    Data allocated during the previous frame stays valid.
+*/
+void bvr_frame_arena_swap(bvr_frame_arena_t* arena);
+
+/*
+    Get the arena used for the current frame.
+*/
+BVR_H_FUNC bvr_arena_t* bvr_frame_arena_get(bvr_frame_arena_t* arena){
+    return &arena->arenas[arena->current];
+}
+
+/*
+    Get the arena used during the previous frame.
+*/
+BVR_H_FUNC bvr_arena_t* bvr_frame_arena_previous(bvr_frame_arena_t* arena){
+    return &arena->arenas[!arena->current];
+}
+
+void bvr_destroy_frame_arena(bvr_frame_arena_t* arena);
+
 void bvr_create_string(bvr_string_t* string, const char* value);
 
 /*
@@ -133,26 +410,64 @@ BVR_H_FUNC const char* bvr_string_get(bvr_string_t* string){
 */
 void bvr_destroy_string(bvr_string_t* string);
 
-void bvr_create_pool(bvr_pool_t* pool, const uint64 size, const uint64 count);
+/*
+    Create a new slot map with room for `count` elements of `size` bytes.
+*/
+void bvr_create_slotmap(bvr_slotmap_t* map, const uint64 size, const uint64 count);
+
+/*
+    Get a pointer to a new writable element.
+    If `handle` is not NULL, it receives element's handle.
+    The pointer is only valid until the next allocation.
+    Returns NULL if the slot map cannot grow.
+*/
+void* bvr_slotmap_alloc(bvr_slotmap_t* map, bvr_handle_t* handle);
+
+/*
+    Get a pointer to the element referenced by `handle`.
+    Returns NULL if the handle is stale.
+*/
+void* bvr_slotmap_get(bvr_slotmap_t* map, bvr_handle_t handle);
+
+/*
+    Get a pointer to the element stored at `index` inside the dense array.
+*/
+BVR_H_FUNC void* bvr_slotmap_at(bvr_slotmap_t* map, uint32 index){
+    if(map && index < map->count){
+        return map->data + (uint64)index * map->elemsize;
+    }
+    return NULL;
+}
+
+/*
+    Get the handle of the element stored at `index` inside the dense array.
+*/
+bvr_handle_t bvr_slotmap_handle_at(bvr_slotmap_t* map, uint32 index);
 
 /*
-    Get a pointer to the next writable slot.
+    Returns BVR_TRUE if the handle still references a living element.
 */
-void* bvr_pool_alloc(bvr_pool_t* pool);
+BVR_H_FUNC int bvr_slotmap_is_valid(bvr_slotmap_t* map, bvr_handle_t handle){
+    return map && map->slots && handle.index < map->capacity &&
+        map->slots[handle.index].generation == handle.generation &&
+        map->slots[handle.index].dense < map->count &&
+        map->owners[map->slots[handle.index].dense] == handle.index;
+}
 
-/* 
-    Try to get a pointer to a writable slot by using an index .
+/*
+    Free the element referenced by `handle`.
+    Returns BVR_FALSE if the handle is stale.
 */
-void* bvr_pool_try_get(bvr_pool_t* pool, int index);
+int bvr_slotmap_free(bvr_slotmap_t* map, bvr_handle_t handle);
 
-/**
-    Deallocate a memory block.
+/*
+    Make sure that the slot map can store `count` elements without growing.
 */
-void bvr_pool_free(bvr_pool_t* pool, void* ptr);
+int bvr_slotmap_reserve(bvr_slotmap_t* map, const uint64 count);
 
-/**
- * Remove an element from the pool by using its value.
- */
-void bvr_pool_remove(bvr_pool_t* pool, const void* value);
+/*
+    Remove all elements, every handle becomes stale.
+*/
+void bvr_slotmap_clear(bvr_slotmap_t* map);
 
-void bvr_destroy_pool(bvr_pool_t* pool);
\ No newline at end of file
+void bvr_destroy_slotmap(bvr_slotmap_t* map);
@@ -6,6 +6,7 @@
 #include <BVR/math.h>
 
 #include <BVR/scene.h>
+#include <BVR/sprites.h>
 #include <BVR/assets.h>
 #include <BVR/assets.book.h>
 #include <BVR/gui.h>
@@ -7,6 +7,14 @@
 #define BVR_CAMERA_ORTHOGRAPHIC 0x1
 #define BVR_CAMERA_PERSPECTIVE  0x2
 
+/*
+    Camera's clipping planes in world space (left, right, bottom, top, near, far).
+    Each plane is stored as (normal, distance), normals point inside the view.
+*/
+struct bvr_frustum_s {
+    vec4 planes[6];
+};
+
 typedef struct bvr_camera_s {
     uint32 mode;
 
@@ -24,6 +32,10 @@ typedef struct bvr_camera_s {
         // perspective scale
         float fov;
     } field_of_view;
+
+    /* last matrices sent to the uniform buffer */
+    mat4x4 view;
+    mat4x4 projection;
 } bvr_camera_t;
 
 /**
@@ -56,6 +68,47 @@ void bvr_update_camera(bvr_camera_t* camera);
  */
 void bvr_camera_lookat(bvr_camera_t*, const vec3 target, const vec3 up);
 
+/**
+ * @brief get the world space box that contains camera's view, 
+ * computed from the last matrices sent by `bvr_update_camera` 
+ * @param camera
+ * @param bounds
+ * @return (void)
+ */
+void bvr_camera_view_bounds(bvr_camera_t* camera, struct bvr_aabb_s* bounds);
+
+/**
+ * @brief get camera's clipping planes, 
+ * computed from the last matrices sent by `bvr_update_camera`
+ * @param camera
+ * @param frustum
+ * @return (void)
+ */
+void bvr_camera_frustum(bvr_camera_t* camera, struct bvr_frustum_s* frustum);
+
+/**
+ * @brief Returns BVR_TRUE if a world space box is inside or intersects the frustum
+ */
+BVR_H_FUNC int bvr_frustum_contains_aabb(const struct bvr_frustum_s* frustum, const struct bvr_aabb_s* aabb){
+    for (int i = 0; i < 6; i++)
+    {
+        const float* plane = frustum->planes[i];
+
+        // box's corner that is the furthest along plane's normal
+        const float distance = 
+            plane[0] * (plane[0] >= 0.0f ? aabb->max[0] : aabb->min[0]) + 
+            plane[1] * (plane[1] >= 0.0f ? aabb->max[1] : aabb->min[1]) + 
+            plane[2] * (plane[2] >= 0.0f ? aabb->max[2] : aabb->min[2]) + 
+            plane[3];
+
+        if(distance < 0.0f){
+            return BVR_FALSE;
+        }
+    }
+
+    return BVR_TRUE;
+}
+
 /**
  * @brief transform a screen coordinate to a world coordinate
  * @param camera
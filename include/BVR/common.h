@@ -1,5 +1,7 @@
 #pragma once
 
+#include <BVR/config.h>
+
 #include <stdio.h>
 
 #ifdef _WIN32
@@ -59,7 +61,22 @@
 /*          UTILS               */
 /*                              */
 
-typedef char bvr_uuid_t[37];
+/*
+    Random 128-bit uuid (version 4), stored as two 64-bit words.
+*/
+typedef uint64 bvr_uuid_t[2];
+
+/*
+    Length of uuid's textual form, including the null character
+*/
+#define BVR_UUID_STRING_LENGTH 37
+
+/*
+    xoshiro256** pseudo random number generator
+*/
+typedef struct bvr_random_s {
+    uint64 state[4];
+} bvr_random_t;
 
 /*
     Return the size of a beauvoir type.
@@ -83,15 +100,54 @@ unsigned int bvr_hash(const char* string);
 unsigned char* bvr_base64_decode(const char* string, size_t length, size_t* decoded_length);
 
 /*
-    Create a new uuid
+    Seed a random generator
+*/
+void bvr_create_random(bvr_random_t* random, uint64 seed);
+
+/*
+    Get the next 64-bit random number
+*/
+uint64 bvr_random_next(bvr_random_t* random);
+
+/*
+    Create a new uuid, each thread uses its own generator.
 */
 void bvr_create_uuid(bvr_uuid_t uuid);
 void bvr_copy_uuid(bvr_uuid_t src, bvr_uuid_t dest);
 
+/*
+    Write uuid's textual form (xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx) into `string`.
+    `string` must be at least BVR_UUID_STRING_LENGTH long.
+*/
+char* bvr_uuid_to_string(bvr_uuid_t const uuid, char* string);
+
+/*
+    Parse uuid's textual form.
+    Returns BVR_FALSE if the string is not a valid uuid.
+*/
+int bvr_uuid_from_string(bvr_uuid_t uuid, const char* string);
+
 /*
     Check if two uuid are equals
 */
-int bvr_uuid_equals(bvr_uuid_t const a, bvr_uuid_t const b);
+BVR_H_FUNC int bvr_uuid_equals(bvr_uuid_t const a, bvr_uuid_t const b){
+    return a[0] == b[0] && a[1] == b[1];
+}
+
+/*
+    Returns BVR_TRUE if uuid has never been created
+*/
+BVR_H_FUNC int bvr_uuid_is_null(bvr_uuid_t const uuid){
+    return (uuid[0] | uuid[1]) == 0;
+}
+
+/*
+    Get uuid's 64-bit hash, used as hash map key.
+    uuid's bits are already random, so there is nothing to compute.
+*/
+BVR_H_FUNC uint64 bvr_uuid_hash(bvr_uuid_t const uuid){
+    return uuid[0] ^ uuid[1];
+}
 
 // check if a flag is true
 #define BVR_HAS_FLAG(x, f) ((int)((x & f) == f))
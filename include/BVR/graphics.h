@@ -31,7 +31,54 @@
 #define BVR_DEPTH_FUNC_NOTEQUAL 0x080
 #define BVR_DEPTH_FUNC_EQUAL    0x100
 
-#define BVR_MAX_DRAW_COMMAND 258
+/*
+    Draw passes, opaque commands are drawn before transparent commands
+*/
+#define BVR_DRAW_PASS_OPAQUE        0
+#define BVR_DRAW_PASS_TRANSPARENT   1
+
+/*
+    Draw command list's initial capacity, the list grows on demand
+*/
+#ifndef BVR_MAX_DRAW_COMMAND
+    #define BVR_MAX_DRAW_COMMAND 258
+#endif
+
+/*
+    Number of instances the instance buffer holds, larger runs are split
+*/
+#ifndef BVR_INSTANCE_BUFFER_SIZE
+    #define BVR_INSTANCE_BUFFER_SIZE 4096
+#endif
+
+/*
+    First vertex attribute location used by per-instance attributes (see BVR_SHADER_EXT_INSTANCING),
+    the matrix takes four locations, followed by the tint and the layer.
+*/
+#define BVR_INSTANCE_ATTRIB_LOCATION 4
+
+/*
+    Number of frame regions of the object buffer (see BVR_SHADER_EXT_OBJECT_BUFFER),
+    a region is rewritten once the GPU finished the frame that used it.
+*/
+#ifndef BVR_OBJECT_BUFFER_FRAMES
+    #define BVR_OBJECT_BUFFER_FRAMES 3
+#endif
+
+/*
+    Number of objects a frame region initially holds, regions grow on demand
+*/
+#ifndef BVR_OBJECT_BUFFER_SIZE
+    #define BVR_OBJECT_BUFFER_SIZE 4096
+#endif
+
+/*
+    Number of texture units tracked by the GL state cache,
+    binds on higher units are always applied
+*/
+#ifndef BVR_GL_MAX_TEXTURE_UNITS
+    #define BVR_GL_MAX_TEXTURE_UNITS 16
+#endif
 
 typedef struct bvr_framebuffer_s {
     uint16 width, target_width;
@@ -50,8 +97,61 @@ struct bvr_pipeline_state_s {
     int flags;
 };
 
+/*
+    Shadow copy of the OpenGL state, calls matching the cached state are skipped.
+    Cached values set to BVR_INVALID_INDEX are unknown and always applied.
+*/
+struct bvr_gl_state_s {
+    uint32 program;
+    uint32 vertex_array;
+
+    // the element buffer binding belongs to the vertex array, it is unknown after each vertex array change
+    uint32 array_buffer;
+    uint32 element_buffer;
+    uint32 uniform_buffer;
+
+    uint32 read_framebuffer;
+    uint32 draw_framebuffer;
+
+    // active unit index, starting at BVR_TEXTURE_UNIT0
+    uint32 active_texture;
+    struct {
+        uint32 target;
+        uint32 id;
+    } textures[BVR_GL_MAX_TEXTURE_UNITS];
+
+    uint32 blending;
+    uint32 blend_src, blend_dst;
+    uint32 depth_testing;
+    uint32 depth_func;
+
+    // number of skipped calls since the last `bvr_gl_state_avoided_calls`
+    uint32 avoided;
+};
+
+/*
+    Per-instance attributes of instanced draws, see BVR_SHADER_EXT_INSTANCING
+*/
+struct bvr_instance_s {
+    mat4x4 matrix;
+    vec4 tint;
+
+    // texture array layer
+    float layer;
+    float padding[3];
+};
+
 struct bvr_draw_command_s {
-    short order;
+    // sort key, see `bvr_opaque_draw_key` and `bvr_transparent_draw_key`
+    uint64 key;
+
+    // instance data, must outlive the frame. Only used if the shader uses BVR_SHADER_EXT_INSTANCING,
+    // consecutive commands sharing mesh, shader and texture are drawn with a single instanced draw.
+    // Shaders using BVR_SHADER_EXT_OBJECT_BUFFER read it from the object buffer instead.
+    struct bvr_instance_s* instance;
+
+    // instance's offset inside the object buffer, written by `bvr_pipeline_upload_objects`
+    uint32 object_offset;
 
     uint32 array_buffer;
     uint32 vertex_buffer;
@@ -66,6 +166,15 @@ struct bvr_draw_command_s {
     bvr_shader_t* shader;
 };
 
+/*
+    Draw commands recorded by a single worker thread
+*/
+struct bvr_command_list_s {
+    struct bvr_draw_command_s* commands;
+    uint32 count;
+    uint32 capacity;
+};
+
 typedef struct bvr_pipeline_s {
     /**
      *   State use for default rendering
@@ -79,10 +188,77 @@ typedef struct bvr_pipeline_s {
     struct bvr_pipeline_state_s swap_pass;
 
     /**
-     *   Store all draw command and the current index
+     *   Store all draw command and the current index,
+     *   command_peak is the highest number of commands of a single frame
+     */
+    struct bvr_draw_command_s* commands;
+    uint32 command_count;
+    uint32 command_capacity;
+    uint32 command_peak;
+
+    /**
+     *   Per-worker command lists, indexed by worker index.
+     *   While recording, commands added by workers go to their own list 
+     *   and are merged into `commands` with `bvr_pipeline_merge_commands`.
      */
-    uint16 command_count;
-    struct bvr_draw_command_s commands[BVR_MAX_DRAW_COMMAND];
+    struct bvr_command_list_s* lists;
+    uint32 list_count;
+    bool recording;
+
+    /**
+     *   Statistics of the last `bvr_draw_page` call
+     */
+    struct bvr_draw_stats_s {
+        uint32 visible;
+        uint32 culled;
+        uint32 submitted;
+
+        // redundant GL calls skipped by the state cache during the last frame
+        uint32 avoided;
+
+        // instanced draw calls of the last flushes, and commands they replaced
+        uint32 instanced_draws;
+        uint32 instanced_commands;
+
+        // per-object constants written to the object buffer
+        uint32 objects;
+
+        // sprites drawn by sprite batches, their draw calls and the bytes they streamed
+        uint32 sprites;
+        uint32 sprite_batches;
+        uint64 streamed_bytes;
+    } stats;
+
+    /**
+     *   Streamed instance buffer, created on the first instanced draw.
+     *   Instances are appended and the buffer is orphaned once full.
+     */
+    struct {
+        uint32 buffer;
+        uint32 count;
+    } instances;
+
+    /**
+     *   Per-object constants ring, created on the first upload.
+     *   The buffer is split in BVR_OBJECT_BUFFER_FRAMES regions, each frame appends to its own region
+     *   and draws bind their range. A fence tells when the GPU is done with a region.
+     */
+    struct {
+        uint32 buffer;
+
+        // object size rounded to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+        uint32 stride;
+
+        uint64 region_size;
+        uint64 cursor;
+        uint32 region;
+
+        // GLsync of each region, NULL if the region is not in flight
+        void* fences[BVR_OBJECT_BUFFER_FRAMES];
+
+        // offset bound to BVR_UNIFORM_BLOCK_OBJECT
+        uint32 bound;
+    } objects;
 
     vec3 clear_color;
 
@@ -100,6 +276,8 @@ struct bvr_predefs {
         bvr_shader_t c_invalid_shader;
         bvr_shader_t c_framebuffer_shader;
         bvr_shader_t c_composite_shader;
+        bvr_shader_t c_sprite_shader;
+        bvr_shader_t c_sprite_atlas_shader;
     } c_shaders;
 
     bool is_available;
@@ -127,6 +305,72 @@ void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd);
  */
 void bvr_pipeline_add_draw_cmd(struct bvr_draw_command_s* cmd);
 
+/**
+ * @brief Start recording draw commands from worker threads, each worker appends to its own list.
+ * @param pipeline
+ * @param worker_count number of workers that can add commands
+ * @return BVR_TRUE on success
+ */
+int bvr_pipeline_begin_recording(bvr_pipeline_t* pipeline, const uint32 worker_count);
+
+/**
+ * @brief Get calling worker's command list.
+ * @param pipeline
+ * @return NULL if the pipeline is not recording or if the caller is not a worker
+ */
+struct bvr_command_list_s* bvr_pipeline_command_list(bvr_pipeline_t* pipeline);
+
+/**
+ * @brief Append `count` commands of a recorded list, starting at `offset`, to pipeline's commands.
+ * @param pipeline
+ * @param list
+ * @param offset
+ * @param count
+ * @return (void)
+ */
+void bvr_pipeline_merge_commands(bvr_pipeline_t* pipeline, const struct bvr_command_list_s* list, const uint32 offset, const uint32 count);
+
+/**
+ * @brief Stop recording, recorded lists are cleared.
+ * @param pipeline
+ * @return (void)
+ */
+void bvr_pipeline_end_recording(bvr_pipeline_t* pipeline);
+
+/**
+ * @brief Draw the command `order[0]` and the following commands that can be drawn with it.
+ * Commands using an instancing shader and sharing mesh, shader and texture are drawn with a single instanced draw.
+ * @param pipeline
+ * @param order command indices in drawing order
+ * @param count number of indices in `order`
+ * @return number of drawn commands
+ */
+uint32 bvr_pipeline_draw_run(bvr_pipeline_t* pipeline, const uint32* order, const uint32 count);
+
+/**
+ * @brief Write the instance of each command using BVR_SHADER_EXT_OBJECT_BUFFER inside current frame's 
+ * object buffer region, with a single mapping. Must be called before the commands are drawn.
+ * @param pipeline
+ * @return (void)
+ */
+void bvr_pipeline_upload_objects(bvr_pipeline_t* pipeline);
+
+/**
+ * @brief Fence the object buffer region written during the last frame and move to the next region,
+ * waits if the GPU still reads it.
+ * @param pipeline
+ * @return (void)
+ */
+void bvr_pipeline_new_frame(bvr_pipeline_t* pipeline);
+
+/**
+ * @brief Sort pipeline's draw commands by key with a radix sort, commands are not moved.
+ * @param pipeline
+ * @param order receives command indices in drawing order, must hold `command_count` indices
+ * @return (void)
+ */
+void bvr_pipeline_sort_commands(bvr_pipeline_t* pipeline, uint32* order);
+
 /** 
  * @brief Poll OpenGL errors
  */
@@ -136,9 +380,92 @@ void bvr_poll_errors(void);
  * @brief Sort two draw commands
  */
 BVR_H_FUNC int bvr_pipeline_compare_commands(const void* a, const void* b){
-    return (((struct bvr_draw_command_s*)a)->order - ((struct bvr_draw_command_s*)b)->order);
+    const uint64 ka = ((struct bvr_draw_command_s*)a)->key;
+    const uint64 kb = ((struct bvr_draw_command_s*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+/*
+    Opaque commands key, commands sharing a shader, a texture and a mesh are drawn together.
+    pass (1) | layer (7) | order (16) | shader (16) | texture (12) | mesh (12)
+*/
+BVR_H_FUNC uint64 bvr_opaque_draw_key(const uint8 layer, const uint16 order, const uint32 shader, const uint32 texture, const uint32 mesh){
+    return ((uint64)BVR_DRAW_PASS_OPAQUE << 63) |
+           ((uint64)(layer & 0x7F) << 56) |
+           ((uint64)order << 40) |
+           ((uint64)(shader & 0xFFFF) << 24) |
+           ((uint64)(texture & 0xFFF) << 12) |
+           ((uint64)(mesh & 0xFFF));
 }
 
+/*
+    Transparent commands key, commands are drawn back to front.
+    pass (1) | layer (7) | order (16) | depth (16) | shader (8) | texture (8) | mesh (8)
+*/
+BVR_H_FUNC uint64 bvr_transparent_draw_key(const uint8 layer, const uint16 order, const uint16 depth, 
+    const uint32 shader, const uint32 texture, const uint32 mesh){
+    
+    return ((uint64)BVR_DRAW_PASS_TRANSPARENT << 63) |
+           ((uint64)(layer & 0x7F) << 56) |
+           ((uint64)order << 40) |
+           ((uint64)depth << 24) |
+           ((uint64)(shader & 0xFF) << 16) |
+           ((uint64)(texture & 0xFF) << 8) |
+           ((uint64)(mesh & 0xFF));
+}
+
+/*
+    Get the transparent key depth of a world height (one unit precision),
+    higher objects are further and are drawn first.
+*/
+BVR_H_FUNC uint16 bvr_draw_depth(const float y){
+    const float depth = 32767.0f - floorf(y);
+    return (uint16)(depth < 0.0f ? 0.0f : (depth > 65535.0f ? 65535.0f : depth));
+}
+
+/*
+    Mark every cached GL value as unknown.
+    Must be called after code that changes GL state without the cache (context creation, nuklear...).
+*/
+void bvr_gl_state_reset(void);
+
+/*
+    Mark cached bindings of `object` as unknown, called before deleting a GL object.
+*/
+void bvr_gl_state_forget(const uint32 object);
+
+/*
+    Returns the number of calls skipped since the last call.
+*/
+uint32 bvr_gl_state_avoided_calls(void);
+
+/*
+    Cached versions of their OpenGL counterparts, engine code should never call them directly.
+    Untracked targets and capabilities are forwarded to OpenGL.
+*/
+void bvr_gl_use_program(const uint32 program);
+void bvr_gl_bind_vertex_array(const uint32 array);
+void bvr_gl_bind_buffer(const uint32 target, const uint32 buffer);
+void bvr_gl_bind_framebuffer(const uint32 target, const uint32 framebuffer);
+void bvr_gl_active_texture(const uint32 unit);
+void bvr_gl_bind_texture(const uint32 target, const uint32 texture);
+void bvr_gl_enable(const uint32 capability);
+void bvr_gl_disable(const uint32 capability);
+void bvr_gl_blend_func(const uint32 src, const uint32 dst);
+void bvr_gl_depth_func(const uint32 func);
+
+void bvr_destroy_command_lists(bvr_pipeline_t* pipeline);
+
+/*
+    Delete pipeline's instance buffer, must be called while the context exists.
+*/
+void bvr_destroy_instance_buffer(bvr_pipeline_t* pipeline);
+
+/*
+    Delete pipeline's object buffer and its fences, must be called while the context exists.
+*/
+void bvr_destroy_object_buffer(bvr_pipeline_t* pipeline);
+
 int bvr_create_framebuffer(bvr_framebuffer_t* framebuffer, const uint16 width, const uint16 height, const char* shader);
 
 /**
@@ -283,7 +283,7 @@ int bvr_create_composite(bvr_composite_t* composite, bvr_image_t* target);
 /*
     Set this composite as the target framebuffer 
 */
-void bvr_composite_enable(bvr_composite_t* composite, bvr_transform_t* const transform);
+void bvr_composite_enable(bvr_composite_t* composite, vec4* const matrix);
 
 /*
     Bind this composite as a texture
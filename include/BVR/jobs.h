@@ -0,0 +1,160 @@
+#pragma once
+
+#include <BVR/config.h>
+#include <BVR/common.h>
+
+#include <pthread.h>
+
+/*
+    Number of worker threads created by the book,
+    0 creates one worker per core (minus the main thread).
+*/
+#ifndef BVR_JOB_THREAD_COUNT
+    #define BVR_JOB_THREAD_COUNT 0
+#endif
+
+/*
+    Capacity of each worker's deque, must be a power of two.
+    Jobs pushed on a full deque are run right away.
+*/
+#ifndef BVR_JOB_QUEUE_SIZE
+    #define BVR_JOB_QUEUE_SIZE 1024
+#endif
+
+/*
+    Maximum number of jobs created by a single `bvr_parallel_for`
+*/
+#ifndef BVR_JOB_MAX_BATCHES
+    #define BVR_JOB_MAX_BATCHES 256
+#endif
+
+typedef void(*bvr_job_func_t)(void* data);
+
+/*
+    Called by `bvr_parallel_for` for each batch of the range [begin, end[
+*/
+typedef void(*bvr_job_range_func_t)(void* data, uint32 begin, uint32 end);
+
+/*
+    Number of unfinished jobs of a group.
+    Counters must be zeroed before their first use, and must outlive their jobs.
+*/
+typedef struct bvr_job_counter_s {
+    volatile int32 value;
+} bvr_job_counter_t;
+
+struct bvr_job_s {
+    bvr_job_func_t func;
+    void* data;
+
+    // decremented when the job is done, can be NULL
+    bvr_job_counter_t* counter;
+
+    // the job is queued once this counter reaches zero, can be NULL
+    bvr_job_counter_t* dependency;
+};
+
+/*
+    Chase-Lev work-stealing deque.
+    The owner pushes and pops at the bottom, other workers steal from the top.
+*/
+struct bvr_job_deque_s {
+    volatile int64 top;
+
+    // thieves write top and the owner writes bottom, keep them on separate cache lines
+    char padding[64 - sizeof(int64)];
+    volatile int64 bottom;
+
+    struct bvr_job_s jobs[BVR_JOB_QUEUE_SIZE];
+};
+
+struct bvr_job_worker_s {
+    struct bvr_job_deque_s deque;
+    struct bvr_job_system_s* system;
+
+    // used to pick a random victim
+    bvr_random_t random;
+
+    pthread_t thread;
+    uint32 index;
+};
+
+typedef struct bvr_job_system_s {
+    // worker 0 is the thread that created the system
+    struct bvr_job_worker_s* workers;
+    uint32 worker_count;
+
+    // number of queued jobs, and number of sleeping workers
+    volatile int32 pending;
+    volatile int32 sleeping;
+    volatile int32 running;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+
+    // jobs waiting for their dependency, protected by `lock`
+    struct bvr_job_s* deferred;
+    uint32 deferred_count;
+    uint32 deferred_capacity;
+} bvr_job_system_t;
+
+/**
+ * @brief create worker threads
+ * @param system
+ * @param thread_count number of worker threads, 0 to create one worker per core
+ * @return BVR_TRUE on success
+ */
+int bvr_create_job_system(bvr_job_system_t* system, uint32 thread_count);
+
+/**
+ * @brief queue a new job
+ * @param system
+ * @param func job's function
+ * @param data job's argument
+ * @param counter incremented now and decremented when the job is done, can be NULL
+ * @return (void)
+ */
+void bvr_job_push(bvr_job_system_t* system, bvr_job_func_t func, void* data, bvr_job_counter_t* counter);
+
+/**
+ * @brief queue a new job that only starts once `dependency` reaches zero
+ * @param system
+ * @param func job's function
+ * @param data job's argument
+ * @param counter incremented now and decremented when the job is done, can be NULL
+ * @param dependency counter to wait for
+ * @return (void)
+ */
+void bvr_job_push_after(bvr_job_system_t* system, bvr_job_func_t func, void* data,
+    bvr_job_counter_t* counter, bvr_job_counter_t* dependency);
+
+/**
+ * @brief wait until `counter` reaches zero. Workers run other jobs while waiting.
+ * @param system
+ * @param counter
+ * @return (void)
+ */
+void bvr_job_wait(bvr_job_system_t* system, bvr_job_counter_t* counter);
+
+/**
+ * @brief split [0, count[ in batches of at least `batch_size` elements,
+ * run them on worker threads and wait for them.
+ * @param system
+ * @param count number of elements
+ * @param batch_size minimum number of elements of each batch
+ * @param func called for each batch
+ * @param data func's argument
+ * @return (void)
+ */
+void bvr_parallel_for(bvr_job_system_t* system, const uint32 count, const uint32 batch_size,
+    bvr_job_range_func_t func, void* data);
+
+/*
+    Returns the index of the calling worker, BVR_INVALID_INDEX if the caller is not a worker.
+*/
+uint32 bvr_job_worker_index(void);
+
+/*
+    Stop and join worker threads. Queued jobs are dropped.
+*/
+void bvr_destroy_job_system(bvr_job_system_t* system);
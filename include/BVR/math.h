@@ -27,6 +27,14 @@ struct bvr_bounds_s {
     float height;
 };
 
+/*
+    Axis aligned bounding box
+*/
+struct bvr_aabb_s {
+    vec3 min;
+    vec3 max;
+};
+
 #define BVR_SCALE_VEC3(vec, a) vec[0] = a; vec[1] = a; vec[2] = a;
 #define BVR_SCALE_VEC4(vec, a) vec[0] = a; vec[1] = a; vec[2] = a; vec[3] = a;
 
@@ -369,6 +377,83 @@ BVR_H_FUNC void mat4_rotate(mat4x4 dest, vec3 angles)
     dest[3][3] = 1.0f;
 }
 
+/*
+    Build a transform matrix from a position, euler angles (in degrees) and an uniform scale.
+    Same result as scale * translation multiplied by mat4_rotate, without the matrix product.
+*/
+BVR_H_FUNC void mat4_compose(mat4x4 dest, const vec3 position, const vec3 angles, const float scale)
+{
+    mat4_rotate(dest, (float*)angles);
+
+    dest[0][0] *= scale; dest[0][1] *= scale; dest[0][2] *= scale;
+    dest[1][0] *= scale; dest[1][1] *= scale; dest[1][2] *= scale;
+    dest[2][0] *= scale; dest[2][1] *= scale; dest[2][2] *= scale;
+
+    dest[3][0] = position[0];
+    dest[3][1] = position[1];
+    dest[3][2] = position[2];
+}
+
+/*
+    Transform a point by `mat`, the result is divided by w.
+*/
+BVR_H_FUNC void mat4_mul_point(vec3 result, mat4x4 const mat, vec3 const point){
+    vec4 temp;
+    for (int i = 0; i < 4; i++)
+    {
+        temp[i] = mat[0][i] * point[0] + mat[1][i] * point[1] + mat[2][i] * point[2] + mat[3][i];
+    }
+
+    const float w = temp[3] != 0.0f ? 1.0f / temp[3] : 1.0f;
+    result[0] = temp[0] * w;
+    result[1] = temp[1] * w;
+    result[2] = temp[2] * w;
+}
+
+/*
+    Grow `aabb` so that it contains `point`
+*/
+BVR_H_FUNC void bvr_aabb_extend(struct bvr_aabb_s* aabb, vec3 const point){
+    for (int i = 0; i < 3; i++)
+    {
+        aabb->min[i] = fminf(aabb->min[i], point[i]);
+        aabb->max[i] = fmaxf(aabb->max[i], point[i]);
+    }
+}
+
+/*
+    Transform `src` by `mat` and store the box that contains the result into `dest`
+*/
+BVR_H_FUNC void bvr_aabb_transform(struct bvr_aabb_s* dest, const struct bvr_aabb_s* src, mat4x4 const mat){
+    struct bvr_aabb_s result;
+
+    for (int i = 0; i < 3; i++)
+    {
+        result.min[i] = mat[3][i];
+        result.max[i] = mat[3][i];
+
+        for (int j = 0; j < 3; j++)
+        {
+            const float a = mat[j][i] * src->min[j];
+            const float b = mat[j][i] * src->max[j];
+
+            result.min[i] += fminf(a, b);
+            result.max[i] += fmaxf(a, b);
+        }
+    }
+
+    memcpy(dest, &result, sizeof(struct bvr_aabb_s));
+}
+
+/*
+    Returns BVR_TRUE if both boxes overlap
+*/
+BVR_H_FUNC int bvr_aabb_overlap(const struct bvr_aabb_s* a, const struct bvr_aabb_s* b){
+    return a->min[0] <= b->max[0] && a->max[0] >= b->min[0] &&
+           a->min[1] <= b->max[1] && a->max[1] >= b->min[1] &&
+           a->min[2] <= b->max[2] && a->max[2] >= b->min[2];
+}
+
 BVR_H_FUNC void quat_rotate(quat quat, float angle, vec3 const axis){
     vec3 axis_normalized;
     vec3_norm(axis_normalized, axis);
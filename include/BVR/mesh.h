@@ -84,7 +84,7 @@ typedef struct bvr_mesh_s {
     uint32 vertex_count;
     uint32 element_count;
     
-    bvr_pool_t vertex_groups;
+    bvr_slotmap_t vertex_groups;
 
     int element_type;
 
@@ -92,6 +92,9 @@ typedef struct bvr_mesh_s {
     uint16 stride;
 
     uint8 attrib_count;
+
+    /* local bounds, computed when the mesh is created. min > max for unbounded meshes */
+    struct bvr_aabb_s bounds;
 } bvr_mesh_t;
 
 /*
@@ -115,6 +118,13 @@ BVR_H_FUNC int bvr_create_mesh(bvr_mesh_t* mesh, const char* path, bvr_mesh_arra
     return status;
 }
 
+/*
+    Returns BVR_TRUE if mesh's bounds are known.
+*/
+BVR_H_FUNC int bvr_mesh_has_bounds(bvr_mesh_t* mesh){
+    return mesh->bounds.min[0] <= mesh->bounds.max[0];
+}
+
 void bvr_triangulate(bvr_mesh_buffer_t* src, bvr_mesh_buffer_t* dest, const uint8 stride);
 
 void bvr_destroy_mesh(bvr_mesh_t* mesh);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <BVR/config.h>
+#include <BVR/common.h>
+#include <BVR/buffer.h>
+
+/*
+    Maximum size of a message's payload, in bytes
+*/
+#ifndef BVR_MESSAGE_PAYLOAD_SIZE
+    #define BVR_MESSAGE_PAYLOAD_SIZE 64
+#endif
+
+/*
+    Number of messages allocated each time the pool grows
+*/
+#ifndef BVR_MESSAGE_CHUNK_SIZE
+    #define BVR_MESSAGE_CHUNK_SIZE 256
+#endif
+
+/*
+    Maximum number of chunks of a message pool
+*/
+#ifndef BVR_MESSAGE_MAX_CHUNKS
+    #define BVR_MESSAGE_MAX_CHUNKS 256
+#endif
+
+typedef struct bvr_message_s {
+    // user defined message type
+    uint32 type;
+
+    // broadcast channel, BVR_NULL_ATOM for messages sent to a single actor
+    bvr_atom_t channel;
+
+    // receiving actor, and sending actor (both page actor handles)
+    bvr_handle_t target;
+    bvr_handle_t sender;
+
+    // message's index inside the pool, and next message inside the pool or the queue
+    uint32 index;
+    uint32 next;
+
+    uint32 size;
+    char payload[BVR_MESSAGE_PAYLOAD_SIZE];
+} bvr_message_t;
+
+/*
+    Multi-producer single-consumer message queue.
+    Messages are pooled inside fixed chunks and linked by their index.
+    Posting never locks, except when the pool has to grow.
+    Queues do not own any thread object, pages holding them can be copied.
+*/
+typedef struct bvr_message_queue_s {
+    bvr_message_t* chunks[BVR_MESSAGE_MAX_CHUNKS];
+    volatile uint32 chunk_count;
+
+    // free messages stack, the upper half is a tag that prevents ABA issues
+    volatile uint64 free;
+
+    // last posted message
+    volatile uint32 head;
+
+    // set while a thread grows the pool
+    volatile int32 growing;
+} bvr_message_queue_t;
+
+void bvr_create_message_queue(bvr_message_queue_t* queue);
+
+/*
+    Get a free message from queue's pool, thread safe.
+    Returns NULL if the pool cannot grow.
+*/
+bvr_message_t* bvr_message_alloc(bvr_message_queue_t* queue);
+
+/*
+    Give back a message to queue's pool, thread safe.
+*/
+void bvr_message_free(bvr_message_queue_t* queue, bvr_message_t* message);
+
+/*
+    Append an allocated message to the queue, thread safe.
+*/
+void bvr_message_post(bvr_message_queue_t* queue, bvr_message_t* message);
+
+/*
+    Take all posted messages, in posting order, only called by the consumer.
+    Returns the first message, the others are reached with `bvr_message_next`.
+*/
+bvr_message_t* bvr_message_take(bvr_message_queue_t* queue);
+
+/*
+    Get the message following `message` in a list returned by `bvr_message_take`.
+*/
+bvr_message_t* bvr_message_next(bvr_message_queue_t* queue, bvr_message_t* message);
+
+void bvr_destroy_message_queue(bvr_message_queue_t* queue);
@@ -3,6 +3,11 @@
 #include <BVR/buffer.h>
 #include <BVR/math.h>
 
+struct bvr_actor_s;
+
+/*
+    Collider collection's initial capacity, the collection grows on demand
+*/
 #ifndef BVR_COLLIDER_COLLECTION_SIZE
     #define BVR_COLLIDER_COLLECTION_SIZE 128
 #endif
@@ -15,7 +20,7 @@
 /*
     Contains an array of collider pointers.
 */
-typedef struct bvr_pool_s bvr_collider_collection_t;
+typedef struct bvr_slotmap_s bvr_collider_collection_t;
 
 typedef enum bvr_collider_shape_e {
     BVR_COLLIDER_EMPTY,
@@ -40,6 +45,12 @@ typedef struct bvr_collider_s {
     bool is_inverted;
 
     struct bvr_transform_s* transform;
+
+    /* actor that owns this collider, NULL for standalone colliders */
+    struct bvr_actor_s* actor;
+
+    /* page's collection handle */
+    bvr_handle_t handle;
 } bvr_collider_t;
 
 struct bvr_collision_result_s {
@@ -57,9 +68,10 @@ struct bvr_collision_result_s {
 void bvr_body_add_force(struct bvr_body_s* body, float x, float y, float z);
 
 /*
-    Translate the body with applied forces
+    Translate the body with applied forces during `delta` seconds, forces are kept.
+    Returns BVR_TRUE if the transform has moved.
 */
-void bvr_body_apply_motion(struct bvr_body_s* body, struct bvr_transform_s* transform);
+int bvr_body_apply_motion(struct bvr_body_s* body, struct bvr_transform_s* transform, const float delta);
 
 void bvr_create_collider(bvr_collider_t* collider, float* vertices, uint64 count);
 
@@ -84,6 +96,11 @@ BVR_H_FUNC int bvr_is_point_inside_triangle(vec2 s, vec2 a, vec2 b, vec2 c){
     );
 }
 
+BVR_H_FUNC void bvr_body_clear_forces(struct bvr_body_s* body){
+    body->acceleration = 0.0f;
+    BVR_IDENTITY_VEC3(body->direction);
+}
+
 BVR_H_FUNC void bvr_invert_direction(struct bvr_body_s* body){
     vec3_scale(body->direction, body->direction, -1.0f);
 }
\ No newline at end of file
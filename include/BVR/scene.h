@@ -9,9 +9,14 @@
 
 #include <BVR/lights.h>
 #include <BVR/camera.h>
+#include <BVR/jobs.h>
+#include <BVR/messages.h>
 
 #include <stdint.h>
 
+/*
+    Page's initial capacities, page containers grow on demand
+*/
 #ifndef BVR_MAX_SCENE_ACTOR_COUNT
     #define BVR_MAX_SCENE_ACTOR_COUNT 64
 #endif
@@ -20,6 +25,39 @@
     #define BVR_MAX_SCENE_LIGHT_COUNT 16
 #endif
 
+/*
+    Default size of page's spatial grid cells (in world units),
+    should stay close to the size of a landscape tile.
+*/
+#ifndef BVR_SPATIAL_CELL_SIZE
+    #define BVR_SPATIAL_CELL_SIZE 32.0f
+#endif
+
+/*
+    Minimum number of local matrices rebuilt by each worker during a transform update
+*/
+#ifndef BVR_TRANSFORM_BATCH_SIZE
+    #define BVR_TRANSFORM_BATCH_SIZE 512
+#endif
+
+/*
+    Minimum number of parallel actor callbacks run by each worker
+*/
+#ifndef BVR_ACTOR_CALLBACK_BATCH_SIZE
+    #define BVR_ACTOR_CALLBACK_BATCH_SIZE 16
+#endif
+
+/*
+    Minimum number of actors culled and recorded by each worker during `bvr_draw_page`
+*/
+#ifndef BVR_DRAW_BATCH_SIZE
+    #define BVR_DRAW_BATCH_SIZE 64
+#endif
+
+#ifndef BVR_FRAME_MEMORY_SIZE
+    #define BVR_FRAME_MEMORY_SIZE 65536
+#endif
+
 #ifndef BVR_NO_SCENE_AUTO_HEAP
     #define BVR_SCENE_AUTO_HEAP
 #endif
@@ -32,6 +70,22 @@
     #define BVR_FRAMERATE (1 / BVR_TARGET_FRAMERATE)
 #endif
 
+/*
+    Default number of simulation ticks per second, 
+    can be changed at runtime with `bvr_set_tick_rate`.
+*/
+#ifndef BVR_TICK_RATE
+    #define BVR_TICK_RATE 60
+#endif
+
+/*
+    Maximum number of simulation ticks run by a single `bvr_update`,
+    remaining time is dropped when the simulation cannot keep up.
+*/
+#ifndef BVR_MAX_TICKS_PER_FRAME
+    #define BVR_MAX_TICKS_PER_FRAME 5
+#endif
+
 /*
     Contains all world's informations and data
 */
@@ -42,14 +96,112 @@ typedef struct bvr_page_s {
     bvr_global_illumination_t global_illumination;
 
     // all world's actors (pointers)
-    bvr_pool_t actors;
+    bvr_slotmap_t actors;
 
-    // all world lights
-    bvr_pool_t lights;
+    // all world lights (pointers)
+    bvr_slotmap_t lights;
 
     // all world's colliders (pointers)
     bvr_collider_collection_t colliders;
 
+    // actor's heap, actors are allocated inside book's garbage stream.
+    // each actor type has its own size class and free list. 
+    struct bvr_actor_heap_s {
+        void* free_lists[BVR_ACTOR_TYPE_COUNT];
+
+        // number of living actors and of bytes used by each size class
+        uint32 counts[BVR_ACTOR_TYPE_COUNT];
+        uint64 sizes[BVR_ACTOR_TYPE_COUNT];
+    } heap;
+
+    // actor's transforms, stored as separate streams.
+    // dirty actor's transform is gathered into the streams and
+    // world matrices are rebuilt in a single batch by bvr_page_update_transforms.
+    // streams are sorted by hierarchy depth, a parent always comes before its children.
+    struct bvr_transform_stream_s {
+        vec3* positions;
+        vec3* rotations;
+        vec3* scales;
+
+        // local matrices, and world matrices (parent's world * local)
+        mat4x4* locals;
+        mat4x4* matrices;
+
+        // world matrices before the last tick, and world matrices interpolated for rendering
+        mat4x4* previous;
+        mat4x4* interpolated;
+
+        // parent's stream index (BVR_INVALID_INDEX for roots) and depth of each transform
+        uint32* parents;
+        uint16* depths;
+
+        // spatial grid cell of each transform
+        uint64* cells;
+
+        // actor that owns each transform
+        struct bvr_actor_s** actors;
+
+        // dirty flag of each transform, and the list of dirty transforms
+        uint8* dirty;
+        uint32* dirty_list;
+        uint32 dirty_count;
+        uint32 dirty_capacity;
+
+        // transforms whose world matrix changed since the last tick started,
+        // their previous and interpolated matrices differ from the current one
+        uint8* moving;
+        uint32* moving_list;
+        uint32 moving_count;
+
+        uint32 count;
+        uint32 capacity;
+
+        // a child has been moved before its parent, streams are sorted again by the next update
+        bool unsorted;
+
+        // parallel callbacks are running, dirty transforms are only flagged
+        bool deferred;
+    } transforms;
+
+    // actor lookup indexes, kept up to date by 
+    // bvr_alloc_actor, bvr_free_actor and bvr_create_actor
+    struct bvr_actor_index_s {
+        // name atom -> actor
+        bvr_hashmap_t names;
+
+        // uuid hash -> actor
+        bvr_hashmap_t uuids;
+
+        // tag atom -> actor
+        bvr_hashmap_t tags;
+
+        // named actors sorted by name, used by prefix queries.
+        // rebuilt by the first prefix query following a change.
+        struct bvr_actor_s** sorted;
+        uint32 sorted_count;
+        uint32 sorted_capacity;
+        bool sorted_dirty;
+    } index;
+
+    // actor's spatial hash grid, keyed on actor's world position (x, y).
+    // actors are moved across cells by bvr_page_update_transforms.
+    struct bvr_spatial_grid_s {
+        // cell key -> actor
+        bvr_hashmap_t cells;
+        float cell_size;
+    } grid;
+
+    // messages posted by actors, delivered by `bvr_dispatch_messages`
+    struct bvr_mailbox_s {
+        bvr_message_queue_t queue;
+
+        // channel atom -> subscribed actor
+        bvr_hashmap_t channels;
+
+        // actor -> subscribed channel
+        bvr_hashmap_t subscriptions;
+    } mailbox;
+
     // scene's callbacks
     struct {
         void(*construct)(struct bvr_page_s* self);
@@ -78,10 +230,25 @@ typedef struct bvr_book_s {
     // this might be used to store assets informations to export them as bundle
     bvr_memstream_t asset_stream;
 
-    // for now, this is not used, but it aims to store 
-    // all scene-actor heap relative elements
+    // asset's path atom -> asset record inside the asset stream
+    bvr_hashmap_t asset_index;
+
+    // asset's uuid hash -> asset record inside the asset stream
+    bvr_hashmap_t asset_uuid_index;
+
+    // store all scene-actor heap relative elements
     bvr_memstream_t garbage_stream;
 
+    // transient per-frame memory, 
+    // allocations stay valid until the end of the next frame
+    bvr_frame_arena_t frame_memory;
+
+    // one transient arena per worker thread (worker 0 uses frame_memory)
+    bvr_frame_arena_t* worker_memory;
+
+    // worker threads shared by engine's systems
+    bvr_job_system_t jobs;
+
     // current page
     bvr_page_t page;
 
@@ -94,6 +261,12 @@ typedef struct bvr_book_s {
         float delta_timef, frame_timer;
         int average_render_time, frames;
         uint64 prev_time, current_time;
+
+        // fixed simulation step, unsimulated time, and interpolation factor between the two last ticks
+        float fixed_delta_timef, accumulator, alpha;
+
+        // number of ticks run by the last update
+        uint32 ticks;
     } timer;
 } bvr_book_t;
 
@@ -109,8 +282,8 @@ bvr_book_t* bvr_get_instance();
 /**
  * @brief Create and allocate common book's memory blocks (asset stream, garbage and predefs)
  * @param book
- * @param asset_size asset memory stream size (in bytes) 
- * @param garbage_size garbage memory stream size (in bytes)
+ * @param asset_size asset memory stream's first page size (in bytes), streams grow on demand
+ * @param garbage_size garbage memory stream's first page size (in bytes), 0 to keep the default one
  * @return (void)
  */
 void bvr_create_book_memories(bvr_book_t* book, const uint64 asset_size, const uint64 garbage_size);
@@ -138,8 +311,46 @@ BVR_H_FUNC int bvr_is_active(bvr_book_t* book){
 */
 void bvr_new_frame(bvr_book_t* book);
 
+/*
+    Advance the simulation by fixed ticks (`book->timer.fixed_delta_timef`) until it catches up with frame's time.
+    Each tick updates page's actors, then collisions and physics.
+*/
 void bvr_update(bvr_book_t* book);
 
+/*
+    Set the number of simulation ticks per second.
+*/
+void bvr_set_tick_rate(bvr_book_t* book, const float rate);
+
+/*
+    Call page actor's callbacks.
+    Callbacks of actors flagged with BVR_ACTOR_PARALLEL_CALLBACK run in batches on book's worker threads, 
+    other callbacks run afterwards on the calling thread.
+*/
+void bvr_update_actors(bvr_book_t* book);
+
+/*
+    Skip page actors outside of camera's view and add visible actor's draw commands,
+    commands are sorted by `bvr_flush`.
+    Actors are culled and recorded in batches on book's worker threads, 
+    layer actors render their composite and are recorded afterwards on the calling thread.
+    Frame statistics are written inside `book->pipeline.stats`.
+*/
+void bvr_draw_page(bvr_book_t* book);
+
+/*
+    Get scratch memory from book's frame arena.
+    Memory is released two frames later, it must never be freed.
+    Worker threads allocate from their own arena.
+*/
+void* bvr_frame_alloc(const uint64 size);
+
+/*
+    Format a string inside book's frame arena.
+    Unlike `BVR_FORMAT`, the string is not overwritten by the next call.
+*/
+char* bvr_frame_format(const char* format, ...);
+
 /*
     render all draw commands
 */
@@ -190,12 +401,181 @@ void bvr_free_actor(bvr_page_t* page, struct bvr_actor_s* actor);
 
 struct bvr_actor_s* bvr_find_actor(bvr_book_t* book, const char* name);
 
+/*
+    Same as `bvr_find_actor`, but compares interned names instead of strings.
+*/
+struct bvr_actor_s* bvr_find_actor_atom(bvr_book_t* book, const bvr_atom_t name);
+
+/*
+    Get the actor referenced by `handle`.
+    Returns NULL if the actor has been freed.
+*/
+struct bvr_actor_s* bvr_get_actor(bvr_page_t* page, bvr_handle_t handle);
+
 struct bvr_actor_s* bvr_find_actor_uuid(bvr_book_t* book, bvr_uuid_t uuid);
 
+/**
+ * @brief find all actors whose name starts with `prefix`
+ * @param book
+ * @param prefix name's prefix
+ * @param actors output array, can be NULL
+ * @param count maximum number of actors written into `actors`
+ * @return total number of matching actors (can be greater than `count`)
+ */
+uint32 bvr_find_actors_prefix(bvr_book_t* book, const char* prefix, struct bvr_actor_s** actors, const uint32 count);
+
+/**
+ * @brief find all actors tagged with `tag`
+ * @param book
+ * @param tag actor's tag
+ * @param actors output array, can be NULL
+ * @param count maximum number of actors written into `actors`
+ * @return total number of matching actors (can be greater than `count`)
+ */
+uint32 bvr_find_actors_tag(bvr_book_t* book, const char* tag, struct bvr_actor_s** actors, const uint32 count);
+uint32 bvr_find_actors_tag_atom(bvr_book_t* book, const bvr_atom_t tag, struct bvr_actor_s** actors, const uint32 count);
+
+/**
+ * @brief find all actors whose position is inside a rectangle, using page's spatial grid.
+ * Positions are the ones of the last transform update.
+ * @param book
+ * @param min rectangle's lower corner
+ * @param max rectangle's upper corner
+ * @param actors output array, can be NULL
+ * @param count maximum number of actors written into `actors`
+ * @return total number of matching actors (can be greater than `count`)
+ */
+uint32 bvr_find_actors_rect(bvr_book_t* book, vec2 const min, vec2 const max, struct bvr_actor_s** actors, const uint32 count);
+
+/**
+ * @brief find all actors whose position is within `radius` of `center`, using page's spatial grid.
+ * Positions are the ones of the last transform update.
+ * @param book
+ * @param center
+ * @param radius
+ * @param actors output array, can be NULL
+ * @param count maximum number of actors written into `actors`
+ * @return total number of matching actors (can be greater than `count`)
+ */
+uint32 bvr_find_actors_radius(bvr_book_t* book, vec2 const center, const float radius, struct bvr_actor_s** actors, const uint32 count);
+
+/*
+    Change the size of page's spatial grid cells and rebuild the grid.
+*/
+void bvr_set_grid_cell_size(bvr_page_t* page, const float cell_size);
+
+/**
+ * @brief send a message to a page actor, can be called from any thread.
+ * The message is delivered to target's `receive` function by the next dispatch.
+ * @param page
+ * @param sender sending actor, can be NULL
+ * @param target receiving actor's handle
+ * @param type user defined message type
+ * @param payload copied inside the message, can be NULL
+ * @param size payload's size, at most BVR_MESSAGE_PAYLOAD_SIZE bytes
+ * @return BVR_FALSE if the payload is too big or if the message pool is full
+ */
+int bvr_send_message(bvr_page_t* page, struct bvr_actor_s* sender, bvr_handle_t target, 
+    const uint32 type, const void* payload, const uint32 size);
+
+/**
+ * @brief send a message to all actors subscribed to `channel`, can be called from any thread.
+ * @param page
+ * @param sender sending actor, can be NULL
+ * @param channel channel's atom
+ * @param type user defined message type
+ * @param payload copied inside the message, can be NULL
+ * @param size payload's size, at most BVR_MESSAGE_PAYLOAD_SIZE bytes
+ * @return BVR_FALSE if the payload is too big or if the message pool is full
+ */
+int bvr_broadcast_message(bvr_page_t* page, struct bvr_actor_s* sender, const bvr_atom_t channel, 
+    const uint32 type, const void* payload, const uint32 size);
+
+/*
+    Subscribe an actor to a broadcast channel.
+    Subscriptions are not thread safe, they must not be changed by parallel callbacks.
+*/
+int bvr_subscribe_actor(bvr_page_t* page, struct bvr_actor_s* actor, const bvr_atom_t channel);
+
+/*
+    Unsubscribe an actor from a channel, or from all its channels if `channel` is BVR_NULL_ATOM.
+*/
+void bvr_unsubscribe_actor(bvr_page_t* page, struct bvr_actor_s* actor, const bvr_atom_t channel);
+
+/*
+    Deliver posted messages in posting order, called by each tick after actor's callbacks.
+    Messages sent by receivers are delivered by the next dispatch.
+    Receivers can change subscriptions and free actors, freed actors do not receive the remaining messages.
+*/
+void bvr_dispatch_messages(bvr_page_t* page);
+
+/*
+    Add actor's name, uuid and tag to page's lookup indexes.
+    Actors must be unindexed before changing their name, uuid or tag by hand.
+*/
+void bvr_index_actor(bvr_page_t* page, struct bvr_actor_s* actor);
+void bvr_unindex_actor(bvr_page_t* page, struct bvr_actor_s* actor);
+
+/*
+    Change actor's name and update page's indexes.
+*/
+void bvr_rename_actor(bvr_page_t* page, struct bvr_actor_s* actor, const char* name);
+
+/*
+    Change actor's tag and update page's indexes.
+*/
+void bvr_set_actor_tag(bvr_page_t* page, struct bvr_actor_s* actor, const char* tag);
+
+/*
+    Rebuild the matrices of page's dirty transforms.
+    Called by `bvr_update`.
+*/
+void bvr_page_update_transforms(bvr_page_t* page);
+
+/*
+    Get actor's world matrix.
+    Page actors use their page's matrix stream, the pointer is valid until the page allocates a new actor.
+    Other actors compute their matrix inside their transform.
+    Parallel callbacks get the matrix of the last transform batch, their own changes are not applied yet.
+*/
+vec4* bvr_get_actor_matrix(struct bvr_actor_s* actor);
+
+/*
+    Get actor's world matrix interpolated between the two last simulation ticks.
+    Use it to draw, and `bvr_get_actor_matrix` to simulate.
+*/
+vec4* bvr_get_actor_render_matrix(struct bvr_actor_s* actor);
+
+/*
+    Flag actor's transform as modified, its matrix will be rebuilt by the next update.
+    Must be called after writing actor's transform values by hand.
+*/
+void bvr_set_actor_dirty(struct bvr_actor_s* actor);
+
+/*
+    Attach actor to `parent`, actor's transform becomes relative to its parent.
+    Both actors must belong to the current page, a NULL parent detaches the actor.
+    Returns BVR_FALSE if the link would create a cycle.
+*/
+int bvr_set_actor_parent(struct bvr_actor_s* actor, struct bvr_actor_s* parent);
+
+/*
+    Transform setters, they flag actor's transform and its children as dirty.
+*/
+void bvr_set_actor_position(struct bvr_actor_s* actor, vec3 const position);
+void bvr_set_actor_rotation(struct bvr_actor_s* actor, vec3 const rotation);
+void bvr_set_actor_scale(struct bvr_actor_s* actor, const float scale);
+void bvr_translate_actor(struct bvr_actor_s* actor, vec3 const offset);
+
 /*
     Register a new non-actor collider inside page's pool.
     Return NULL if cannot register collider.
 */
 bvr_collider_t* bvr_register_collider(bvr_page_t* page, bvr_collider_t* collider);
 
+/*
+    Remove a collider from page's pool.
+*/
+void bvr_unregister_collider(bvr_page_t* page, bvr_collider_t* collider);
+
 void bvr_destroy_page(bvr_page_t* page);
\ No newline at end of file
@@ -12,10 +12,12 @@
 
 #define BVR_UNIFORM_GLOBAL_ILLUMINATION_NAME "bvr_global_illumination"
 #define BVR_UNIFORM_SHARE_LAYER_NAME "bvr_layers"
+#define BVR_UNIFORM_OBJECT_NAME "bvr_object"
 
 #define BVR_UNIFORM_BLOCK_CAMERA                0x0
 #define BVR_UNIFORM_BLOCK_GLOBAL_ILLUMINATION   0x1
 #define BVR_UNIFORM_BLOCK_LAYERS                0x2
+#define BVR_UNIFORM_BLOCK_OBJECT                0x3
 
 #define BVR_MAX_SHADER_COUNT 3
 #define BVR_MAX_UNIFORM_COUNT 20
@@ -28,6 +30,13 @@
 #define BVR_SHADER_EXT_LIGHT            0x100
 #define BVR_SHADER_EXT_SHARE_LAYERS     0x200
 
+// vertex stage gets per-instance attributes, actors are drawn instanced
+#define BVR_SHADER_EXT_INSTANCING       0x400
+
+// stages get the `bvr_object` block (bvr_transform, bvr_object_tint, bvr_object_layer),
+// transforms are read from the pipeline's object buffer instead of being uploaded per draw
+#define BVR_SHADER_EXT_OBJECT_BUFFER    0x800
+
 #define BVR_SHADER_EXT_GLOBAL_ILLUMINATION BVR_SHADER_EXT_LIGHT
 
 enum bvr_uniform_tag_e {
@@ -44,11 +53,14 @@ enum bvr_uniform_tag_e {
 typedef struct bvr_shader_uniform_s {
     struct bvr_buffer_s memory;
 
-    bvr_string_t name;
+    bvr_atom_t name;
     short location;
 
     uint16 type;
     uint16 tags;
+
+    // uniform version of the last `bvr_shader_set_uniformi` call
+    uint64 version;
 } bvr_shader_uniform_t;
 
 typedef struct bvr_shader_stage_s {
@@ -74,6 +86,9 @@ typedef struct bvr_shader_s {
     
     int flags;
     struct bvr_asset_reference_s asset;
+
+    // uniform version of the last upload, uniforms set after it are uploaded when enabled
+    uint64 uploaded;
 } bvr_shader_t;
 
 
@@ -138,14 +153,14 @@ BVR_H_FUNC bvr_shader_uniform_t* bvr_find_uniform_tag(bvr_shader_t* shader, enum
     return NULL;
 }
 
-BVR_H_FUNC bvr_shader_uniform_t* bvr_find_uniform(bvr_shader_t* shader, const char* name){
+BVR_H_FUNC bvr_shader_uniform_t* bvr_find_uniform_atom(bvr_shader_t* shader, const bvr_atom_t name){
+    if(name == BVR_NULL_ATOM){
+        return NULL;
+    }
+
     for (uint64 i = 1; i < shader->uniform_count; i++)
     {
-        if(!shader->uniforms[i].name.length){
-            continue;
-        }
-        
-        if (strcmp(shader->uniforms[i].name.string, name) == 0) {
+        if (shader->uniforms[i].name == name) {
             return &shader->uniforms[i];
         }
     }
@@ -153,6 +168,17 @@ BVR_H_FUNC bvr_shader_uniform_t* bvr_find_uniform(bvr_shader_t* shader, const ch
     return NULL;
 }
 
+/*
+    Prefer `bvr_find_uniform_atom` inside hot paths, this version must hash the string first.
+*/
+BVR_H_FUNC bvr_shader_uniform_t* bvr_find_uniform(bvr_shader_t* shader, const char* name){
+    return bvr_find_uniform_atom(shader, bvr_find_atom(name));
+}
+
+/*
+    Set uniform's data pointer, the data is uploaded the next time the shader is enabled.
+    Modifying pointed data must be followed by another call, otherwise the change is not uploaded.
+*/
 int bvr_shader_set_uniformi(bvr_shader_uniform_t* uniform, void* data);
 BVR_H_FUNC int bvr_shader_set_texturei(bvr_shader_uniform_t* uniform, void* texture){
     return bvr_shader_set_uniformi(uniform, texture);
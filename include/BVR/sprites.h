@@ -0,0 +1,132 @@
+#pragma once
+
+#include <BVR/config.h>
+#include <BVR/common.h>
+#include <BVR/math.h>
+
+#include <BVR/shader.h>
+#include <BVR/image.h>
+
+/*
+    Maximum number of sprites drawn by a single draw call,
+    vertices are indexed with 16 bits indices so it cannot exceed 16384.
+*/
+#ifndef BVR_SPRITE_BATCH_SIZE
+    #define BVR_SPRITE_BATCH_SIZE 16384
+#endif
+
+/*
+    Size of the streaming vertex buffer in bytes,
+    must hold at least one full batch (BVR_SPRITE_BATCH_SIZE * 4 vertices).
+*/
+#ifndef BVR_SPRITE_BUFFER_SIZE
+    #define BVR_SPRITE_BUFFER_SIZE (8 << 20)
+#endif
+
+typedef struct bvr_sprite_s {
+    // world position of sprite's center
+    vec3 position;
+    vec2 size;
+
+    // rotation around the z axis, in radians
+    float rotation;
+
+    // texture coordinates (u0, v0, u1, v1)
+    vec4 uvs;
+    vec4 color;
+
+    // atlas layer, ignored by 2D textures
+    uint32 layer;
+} bvr_sprite_t;
+
+struct bvr_sprite_vertex_s {
+    vec3 position;
+
+    // the third coordinate is the atlas layer
+    vec3 uvs;
+
+    // RGBA8 color
+    uint32 color;
+};
+
+/*
+    Streams transformed quads into a vertex buffer ring,
+    sprites are drawn by batches sharing a texture and a shader.
+    The buffer is written through an unsynchronized mapping and orphaned once full.
+*/
+typedef struct bvr_sprite_batch_s {
+    uint32 array_buffer;
+    uint32 vertex_buffer;
+    uint32 element_buffer;
+
+    // write offset inside the vertex buffer, in bytes
+    uint64 cursor;
+
+    // mapped vertices of the current batch, NULL if the buffer is not mapped
+    struct bvr_sprite_vertex_s* vertices;
+    uint32 count;
+
+    // NULL shader uses the predefined sprite shaders
+    bvr_shader_t* shader;
+    bvr_texture_t* texture;
+
+    bool drawing;
+
+    /**
+     *   Statistics of the last begin/end pass
+     */
+    struct bvr_sprite_stats_s {
+        uint32 sprites;
+        uint32 batches;
+        uint64 bytes;
+    } stats;
+} bvr_sprite_batch_t;
+
+/**
+ * @brief create batch's vertex array, its streaming vertex buffer and its quad indices
+ * @param batch
+ * @return BVR_TRUE on success
+ */
+int bvr_create_sprite_batch(bvr_sprite_batch_t* batch);
+
+/**
+ * @brief start a new pass, sprites are drawn as soon as a batch is full,
+ * the texture or the shader changes, or when the pass ends.
+ * @param batch
+ * @param shader sprites' shader, NULL to use the predefined sprite shaders
+ * @return (void)
+ */
+void bvr_sprite_batch_begin(bvr_sprite_batch_t* batch, bvr_shader_t* shader);
+
+/**
+ * @brief append a sprite to the current batch
+ * @param batch
+ * @param texture sprite's texture, bound to BVR_TEXTURE_UNIT0
+ * @param sprite
+ * @return (void)
+ */
+void bvr_sprite_batch_push(bvr_sprite_batch_t* batch, bvr_texture_t* texture, const bvr_sprite_t* sprite);
+
+/*
+    Append an atlas tile, sprites sharing the atlas stay in the same batch whatever their layer.
+*/
+BVR_H_FUNC void bvr_sprite_batch_push_tile(bvr_sprite_batch_t* batch, bvr_texture_atlas_t* atlas, const bvr_sprite_t* sprite){
+    bvr_sprite_batch_push(batch, &atlas->texture, sprite);
+}
+
+/**
+ * @brief change sprites' shader, draws the current batch if the shader is different
+ * @param batch
+ * @param shader NULL to use the predefined sprite shaders
+ * @return (void)
+ */
+void bvr_sprite_batch_set_shader(bvr_sprite_batch_t* batch, bvr_shader_t* shader);
+
+/**
+ * @brief draw remaining sprites and end the pass
+ * @param batch
+ * @return (void)
+ */
+void bvr_sprite_batch_end(bvr_sprite_batch_t* batch);
+
+void bvr_destroy_sprite_batch(bvr_sprite_batch_t* batch);
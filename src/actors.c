@@ -11,29 +11,14 @@
 #include <GLAD/glad.h>
 
 /*
-    calculate actor's transformation matrix
+    Get a snapshot of actor's world matrix.
+    Commands are drawn later, and the matrix stream can move in between.
 */
-static void bvri_update_transform(bvr_transform_t* transform){
-    BVR_ASSERT(transform);
+static vec4* bvri_snapshot_matrix(struct bvr_actor_s* actor){
+    vec4* matrix = bvr_frame_alloc(sizeof(mat4x4));
+    memcpy(matrix, bvr_get_actor_render_matrix(actor), sizeof(mat4x4));
 
-    mat4x4 rotation_mat;
-
-    BVR_IDENTITY_MAT4(rotation_mat);
-    BVR_IDENTITY_MAT4(transform->matrix);
-
-    mat4_rotate(rotation_mat, transform->rotation);
-
-    // copy translation to the translate matrix
-    transform->matrix[3][0] = transform->position[0];
-    transform->matrix[3][1] = transform->position[1];
-    transform->matrix[3][2] = transform->position[2];
-
-    // scale matrix
-    transform->matrix[0][0] = transform->scale[0];
-    transform->matrix[1][1] = transform->scale[0];
-    transform->matrix[2][2] = transform->scale[0];
-
-    mat4_mul(transform->matrix, transform->matrix, rotation_mat);
+    return matrix;
 }
 
 /*
@@ -42,6 +27,7 @@ static void bvri_update_transform(bvr_transform_t* transform){
 static void bvri_create_generic_dynactor(bvr_dynamic_actor_t* actor, int flags){
     bvr_create_collider(&actor->collider, NULL, 0);
     actor->collider.transform = &actor->self.transform;
+    actor->collider.actor = &actor->self;
 
     actor->collider.body.mode = BVR_COLLISION_DISABLE;
     actor->collider.shape = BVR_COLLIDER_EMPTY;
@@ -80,7 +66,7 @@ static void bvri_create_dynamic_actor(bvr_dynamic_actor_t* actor, int flags){
             struct bvr_bounds_s bounds;
 
             // get a pointer to mesh's vertices
-            glBindBuffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
+            bvr_gl_bind_buffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
             vertices = glMapBufferRange(GL_ARRAY_BUFFER, 0, actor->mesh.vertex_count, GL_MAP_READ_BIT);
             BVR_ASSERT(vertices);
 
@@ -110,7 +96,7 @@ static void bvri_create_dynamic_actor(bvr_dynamic_actor_t* actor, int flags){
             memcpy(actor->collider.geometry.data, &bounds, actor->collider.geometry.size);
 
             glUnmapBuffer(GL_ARRAY_BUFFER);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
         }
         else {
             BVR_PRINT("failed to copy vertices data!");
@@ -128,7 +114,7 @@ static void bvri_create_dynamic_actor(bvr_dynamic_actor_t* actor, int flags){
             char* vmap;
 
             // get raw data
-            glBindBuffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
+            bvr_gl_bind_buffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
             vmap = glMapBufferRange(GL_ARRAY_BUFFER, 0, actor->mesh.vertex_count, GL_MAP_READ_BIT);
             BVR_ASSERT(vmap);
 
@@ -143,7 +129,7 @@ static void bvri_create_dynamic_actor(bvr_dynamic_actor_t* actor, int flags){
             bvr_triangulate(&sbuf, &tbuf, 2);
             
             glUnmapBuffer(GL_ARRAY_BUFFER);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
 
             // allocate and copy geometry
             actor->collider.geometry.elemsize = sizeof(vec2) * 3;
@@ -284,11 +270,11 @@ static void bvri_create_landscape(bvr_landscape_actor_t* landscape, int flags){
     bvr_create_meshv(&landscape->mesh, &vertices_buffer, &element_buffer, BVR_MESH_ATTRIB_SINGLE);
     
     // TODO: avoid recreating pool
-    bvr_destroy_pool(&landscape->mesh.vertex_groups);
-    bvr_create_pool(&landscape->mesh.vertex_groups, sizeof(bvr_vertex_group_t), landscape->dimension.layers);
+    bvr_destroy_slotmap(&landscape->mesh.vertex_groups);
+    bvr_create_slotmap(&landscape->mesh.vertex_groups, sizeof(bvr_vertex_group_t), landscape->dimension.layers);
     for (size_t i = 0; i < landscape->dimension.layers; i++)
     {
-        bvr_vertex_group_t* group = bvr_pool_alloc(&landscape->mesh.vertex_groups);
+        bvr_vertex_group_t* group = bvr_slotmap_alloc(&landscape->mesh.vertex_groups, NULL);
         group->name.length = 0;
         group->name.string = NULL;
         group->element_offset = (vertex_count / landscape->dimension.layers) * i;
@@ -302,19 +288,35 @@ static void bvri_create_landscape(bvr_landscape_actor_t* landscape, int flags){
 void bvr_create_actor(struct bvr_actor_s* actor, const char* name, int flags, bvr_actor_event_t event){
     BVR_ASSERT(actor);
 
+    // actors allocated by the current page are indexed by their name and uuid
+    bvr_page_t* page = &bvr_get_instance()->page;
+    if(bvr_get_actor(page, actor->handle) != actor){
+        page = NULL;
+    }
+
+    if(page){
+        bvr_unindex_actor(page, actor);
+    }
+
     actor->flags = flags;
     actor->order_in_layer = 0;
     actor->active = true;
     actor->callback = event;
+    actor->receive = NULL;
 
     BVR_IDENTITY_VEC3(actor->transform.position);
     BVR_IDENTITY_VEC3(actor->transform.rotation);
     BVR_SCALE_VEC3(actor->transform.scale, 1.0f);
     BVR_IDENTITY_MAT4(actor->transform.matrix);
     
-    bvr_create_string(&actor->name, name);
+    actor->name = bvr_intern(name);
     bvr_create_uuid(actor->id);
 
+    if(page){
+        bvr_index_actor(page, actor);
+        bvr_set_actor_dirty(actor);
+    }
+
     switch (actor->type)
     {
     case BVR_EMPTY_ACTOR:
@@ -347,9 +349,9 @@ void bvr_create_actor(struct bvr_actor_s* actor, const char* name, int flags, bv
 void bvr_destroy_actor(struct bvr_actor_s* actor){
     BVR_ASSERT(actor);
 
-    if(actor->name.string){
-        bvr_destroy_string(&actor->name);
-    }
+    // interned strings are never freed
+    actor->name = BVR_NULL_ATOM;
+    actor->tag = BVR_NULL_ATOM;
 
     switch (actor->type)
     {
@@ -406,7 +408,13 @@ void bvr_destroy_actor(struct bvr_actor_s* actor){
 
 static void bvri_draw_layer_actor(bvr_layer_actor_t* actor, int drawmode){
     struct bvr_draw_command_s cmd;
-    mat4x4 identity;
+    cmd.instance = NULL;
+    vec4* matrix = bvri_snapshot_matrix(&actor->self);
+
+    // uniforms keep a pointer to their values, 
+    // so temporary values must outlive this function
+    vec4* identity = bvr_frame_alloc(sizeof(mat4x4));
+    struct bvr_layer_info_s* layer_info = bvr_frame_alloc(sizeof(struct bvr_layer_info_s));
     
     mat4_ortho(
         identity,
@@ -415,7 +423,7 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor, int drawmode){
     );
 
     // bind composite
-    bvr_composite_enable(&actor->composite, &actor->self.transform);
+    bvr_composite_enable(&actor->composite, matrix);
 
     // update composite texture reference
     bvr_shader_set_uniformi(
@@ -427,14 +435,13 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor, int drawmode){
 
     // draw each layers on the composite framebuffer
     bvr_layer_t* layer;
-    struct bvr_layer_info_s layer_info;
     for (int i = 0; i < BVR_BUFFER_COUNT(actor->texture.image.layers); i++)
     {
         layer = &((bvr_layer_t*)actor->texture.image.layers.data)[i];
         
-        layer_info.layer = i;
-        layer_info.blend_mode = layer->blend_mode;
-        layer_info.opacity = layer->opacity;
+        layer_info->layer = i;
+        layer_info->blend_mode = layer->blend_mode;
+        layer_info->opacity = layer->opacity;
         
         // reset transform matrice
         identity[3][0] = (float)layer->anchor_x / actor->texture.image.width;
@@ -446,7 +453,7 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor, int drawmode){
         // update layer info
         bvr_shader_set_uniformi(
             bvr_find_uniform_tag(&actor->shader, BVR_UNIFORM_LAYER_INDEX),
-            &layer_info
+            layer_info
         );
 
         //cmd.order = actor->self.order_in_layer + i;
@@ -470,7 +477,7 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor, int drawmode){
         //}
 
         cmd.draw_mode = drawmode;
-        cmd.vertex_group = *(bvr_vertex_group_t*)bvr_pool_try_get(&actor->mesh.vertex_groups, 0);
+        cmd.vertex_group = *(bvr_vertex_group_t*)bvr_slotmap_at(&actor->mesh.vertex_groups, 0);
         cmd.vertex_group.texture = actor->texture.id;
 
         bvr_pipeline_draw_cmd(&cmd);
@@ -487,10 +494,9 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor, int drawmode){
     // update transform
     bvr_shader_set_uniformi(
         bvr_find_uniform_tag(cmd.shader, BVR_UNIFORM_TRANSFORM),
-        actor->self.transform.matrix
+        matrix
     );
 
-    cmd.order = actor->self.order_in_layer;
     cmd.array_buffer = actor->mesh.array_buffer;
     cmd.vertex_buffer = actor->mesh.vertex_buffer;
     cmd.element_buffer = actor->mesh.element_buffer;
@@ -499,20 +505,20 @@ static void bvri_draw_layer_actor(bvr_layer_actor_t* actor, int drawmode){
 
     cmd.draw_mode = drawmode;
 
-    cmd.vertex_group = *(bvr_vertex_group_t*)bvr_pool_try_get(&actor->mesh.vertex_groups, 0);
+    cmd.vertex_group = *(bvr_vertex_group_t*)bvr_slotmap_at(&actor->mesh.vertex_groups, 0);
     cmd.vertex_group.texture = actor->composite.tex;
+    cmd.key = bvr_actor_draw_key(&actor->self, cmd.shader->program, actor->composite.tex, actor->mesh.array_buffer);
 
     bvr_pipeline_add_draw_cmd(&cmd);
 }
 
 static void bvri_draw_landscape_actor(bvr_landscape_actor_t* actor){
     struct bvr_draw_command_s cmd;
+    cmd.instance = NULL;
 
     // update transform
-    bvr_shader_set_uniformi(&actor->shader.uniforms[0], actor->self.transform.matrix);
+    bvr_shader_set_uniformi(&actor->shader.uniforms[0], bvri_snapshot_matrix(&actor->self));
     
-    cmd.order = actor->self.order_in_layer;
-
     cmd.array_buffer = actor->mesh.array_buffer;
     cmd.vertex_buffer = actor->mesh.vertex_buffer;
     cmd.element_buffer = 0; // does not have element buffer
@@ -523,9 +529,10 @@ static void bvri_draw_landscape_actor(bvr_landscape_actor_t* actor){
 
     // draw mode is forced to be 'triangle strip'
     cmd.draw_mode = BVR_DRAWMODE_TRIANGLES_STRIP;
+    cmd.key = bvr_actor_draw_key(&actor->self, actor->shader.program, actor->atlas.texture.id, actor->mesh.array_buffer);
 
     bvr_vertex_group_t group;
-    BVR_POOL_FOR_EACH(group, actor->mesh.vertex_groups){
+    BVR_SLOTMAP_FOR_EACH(group, actor->mesh.vertex_groups){
         cmd.vertex_group = group;
         
         bvr_pipeline_add_draw_cmd(&cmd);
@@ -541,14 +548,37 @@ void bvr_draw_actor(struct bvr_actor_s* actor, int drawmode){
     // actor's callback
     BVR_CALL(actor->callback, actor);
 
+    bvr_submit_actor(actor, drawmode);
+}
+
+uint64 bvr_actor_draw_key(struct bvr_actor_s* actor, const uint32 shader, const uint32 texture, const uint32 mesh){
+    const int y_sorted = BVR_HAS_FLAG(actor->flags, BVR_DYNACTOR_Y_SORTED);
+
+    if(actor->type == BVR_LAYER_ACTOR || actor->type == BVR_TEXTURE_ACTOR || 
+        y_sorted || BVR_HAS_FLAG(actor->flags, BVR_ACTOR_TRANSPARENT)){
+        
+        // 2.5D ordering
+        uint16 depth = 0;
+        if(y_sorted){
+            depth = bvr_draw_depth(bvr_get_actor_render_matrix(actor)[3][1]);
+        }
+
+        return bvr_transparent_draw_key(0, actor->order_in_layer, depth, shader, texture, mesh);
+    }
+
+    return bvr_opaque_draw_key(0, actor->order_in_layer, shader, texture, mesh);
+}
+
+void bvr_submit_actor(struct bvr_actor_s* actor, int drawmode){
+    if(bvr_is_actor_null(actor) || !actor->active){
+        return;
+    }
+
     // empty actors cannot be drawn
     if(actor->type == BVR_EMPTY_ACTOR){
         return;
     }
 
-    // calculate transforms    
-    bvri_update_transform(&actor->transform);
-
     // layered actors are drawn differentlty
     if(actor->type == BVR_LAYER_ACTOR){
         bvri_draw_layer_actor((bvr_layer_actor_t*)actor, drawmode);
@@ -564,14 +594,29 @@ void bvr_draw_actor(struct bvr_actor_s* actor, int drawmode){
     // update shaders transform
     bvr_static_actor_t* _actor = (bvr_static_actor_t*)actor;
 
-    // update actor's transform
-    bvr_shader_set_uniformi(&_actor->shader.uniforms[0], actor->transform.matrix);
-
     // create the draw command
     struct bvr_draw_command_s cmd;
-    
-    cmd.order = actor->order_in_layer;
+    cmd.instance = NULL;
+    cmd.object_offset = BVR_INVALID_INDEX;
 
+    // instanced shaders read the transform from the instance buffer, 
+    // object buffer shaders from their range of the object buffer
+    if(BVR_HAS_FLAG(_actor->shader.flags, BVR_SHADER_EXT_INSTANCING) ||
+        BVR_HAS_FLAG(_actor->shader.flags, BVR_SHADER_EXT_OBJECT_BUFFER)){
+        
+        cmd.instance = bvr_frame_alloc(sizeof(struct bvr_instance_s));
+    }
+
+    if(cmd.instance){
+        memcpy(cmd.instance->matrix, bvr_get_actor_render_matrix(actor), sizeof(mat4x4));
+        BVR_SCALE_VEC4(cmd.instance->tint, 1.0f);
+        cmd.instance->layer = 0.0f;
+    }
+    else {
+        // update actor's transform
+        bvr_shader_set_uniformi(&_actor->shader.uniforms[0], bvri_snapshot_matrix(actor));
+    }
+    
     cmd.array_buffer = _actor->mesh.array_buffer;
     cmd.vertex_buffer = _actor->mesh.vertex_buffer;
     cmd.element_buffer = _actor->mesh.element_buffer;
@@ -581,10 +626,17 @@ void bvr_draw_actor(struct bvr_actor_s* actor, int drawmode){
     cmd.shader = &_actor->shader;
     cmd.draw_mode = drawmode;
 
+    uint32 texture = 0;
+    if(actor->type == BVR_TEXTURE_ACTOR){
+        texture = ((bvr_texture_actor_t*)actor)->bitmap.id;
+    }
+
     // iterate through each vertex group to create individual draw commands
     bvr_vertex_group_t group;
-    BVR_POOL_FOR_EACH(group, _actor->mesh.vertex_groups){
+    BVR_SLOTMAP_FOR_EACH(group, _actor->mesh.vertex_groups){
         cmd.vertex_group = group;
+        cmd.vertex_group.texture = group.texture ? group.texture : texture;
+        cmd.key = bvr_actor_draw_key(actor, _actor->shader.program, group.texture ? group.texture : texture, _actor->mesh.array_buffer);
         
         // if it's not invisible the command is added to the queue
         if(!BVR_HAS_FLAG(group.flags, BVR_VERTEX_GROUP_FLAG_INVISIBLE)){
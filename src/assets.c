@@ -28,6 +28,69 @@ struct bvri_header_data_s {
 
 #pragma region asset db
 
+/*
+    Asset records are stored as [uuid][path length][path][open mode].
+    Records are always written as one block, so that they never overlap two stream's pages.
+*/
+static void bvri_decode_asset_record(char* record, bvr_asset_t* asset){
+    uint16 string_length;
+    memcpy(&string_length, record + sizeof(bvr_uuid_t), sizeof(uint16));
+
+    memcpy(&asset->id, record, sizeof(bvr_uuid_t));
+    asset->path.length = string_length;
+    asset->path.string = record + sizeof(bvr_uuid_t) + sizeof(uint16);
+    asset->open_mode = record[sizeof(bvr_uuid_t) + sizeof(uint16) + string_length];
+}
+
+static bvr_uuid_t* bvri_read_asset_record(bvr_memstream_t* stream, bvr_asset_t* asset){
+    uint16 string_length;
+    char* record = bvr_memstream_peek(stream, sizeof(bvr_uuid_t) + sizeof(uint16));
+
+    if(!record){
+        return NULL;
+    }
+
+    memcpy(&string_length, record + sizeof(bvr_uuid_t), sizeof(uint16));
+
+    const uint64 record_size = sizeof(bvr_uuid_t) + sizeof(uint16) + string_length + sizeof(char);
+    if(!bvr_memstream_peek(stream, record_size)){
+        BVR_PRINT("corrupted asset record!");
+        return NULL;
+    }
+
+    if(asset){
+        bvri_decode_asset_record(record, asset);
+    }
+
+    bvr_memstream_seek(stream, record_size, SEEK_CUR);
+    return (bvr_uuid_t*)record;
+}
+
+/*
+    Rebuild asset's path index from the asset stream.
+*/
+static void bvri_index_assets(bvr_book_t* book){
+    bvr_uuid_t* record;
+    bvr_asset_t asset;
+
+    bvr_hashmap_clear(&book->asset_index);
+    bvr_hashmap_clear(&book->asset_uuid_index);
+
+    bvr_memstream_seek(&book->asset_stream, 0, SEEK_SET);
+    while (!bvr_memstream_eof(&book->asset_stream))
+    {
+        record = bvri_read_asset_record(&book->asset_stream, &asset);
+        if(!record){
+            break;
+        }
+
+        bvr_hashmap_insert(&book->asset_index, bvr_intern(asset.path.string), record);
+        bvr_hashmap_insert(&book->asset_uuid_index, bvr_uuid_hash(asset.id), record);
+    }
+
+    bvr_memstream_seek(&book->asset_stream, 0, SEEK_NEXT);
+}
+
 bvr_uuid_t* bvr_register_asset(const char* path, char open_mode){
     BVR_ASSERT(path);
 
@@ -39,11 +102,6 @@ bvr_uuid_t* bvr_register_asset(const char* path, char open_mode){
         return NULL;
     }   
 
-    if(!book->asset_stream.data){
-        BVR_PRINT("asset stream is not created!");
-        return NULL;
-    }
-
     bvr_asset_t asset;
     bvr_uuid_t* uuid = bvr_find_asset(path, NULL);
     
@@ -57,58 +115,43 @@ bvr_uuid_t* bvr_register_asset(const char* path, char open_mode){
     bvr_create_uuid(asset.id);
     bvr_create_string(&asset.path, path);
 
+    // reserve the whole record, its address stays valid while the stream grows
     bvr_memstream_seek(&book->asset_stream, 0, SEEK_NEXT);
-    bvr_uuid_t* id_ptr = (bvr_uuid_t*)book->asset_stream.cursor;
+    char* record = bvr_memstream_write(&book->asset_stream, NULL, 
+        sizeof(bvr_uuid_t) + sizeof(uint16) + asset.path.length + sizeof(char)
+    );
+
+    memcpy(record, asset.id, sizeof(bvr_uuid_t));
+    memcpy(record + sizeof(bvr_uuid_t), &asset.path.length, sizeof(uint16));
+    memcpy(record + sizeof(bvr_uuid_t) + sizeof(uint16), asset.path.string, asset.path.length);
+    record[sizeof(bvr_uuid_t) + sizeof(uint16) + asset.path.length] = asset.open_mode;
 
-    bvr_memstream_write(&book->asset_stream, asset.id, sizeof(bvr_uuid_t));
-    bvr_memstream_write(&book->asset_stream, &asset.path.length, sizeof(unsigned short));
-    bvr_memstream_write(&book->asset_stream, asset.path.string, asset.path.length);
-    bvr_memstream_write(&book->asset_stream, &asset.open_mode, sizeof(char));
+    bvr_hashmap_insert(&book->asset_index, bvr_intern(path), record);
+    bvr_hashmap_insert(&book->asset_uuid_index, bvr_uuid_hash(asset.id), record);
 
     bvr_destroy_string(&asset.path);
-    return id_ptr;
+    return (bvr_uuid_t*)record;
 }
 
-// TODO: improve with an hash map
 bvr_uuid_t* bvr_find_asset(const char* path, bvr_asset_t* asset){
     BVR_ASSERT(path);
 
-    bvr_book_t* book = bvr_get_instance();
-
-    bvr_uuid_t* uuid = NULL;
-    uint16 string_length;
-    const char* prev_cursor = book->asset_stream.cursor;
-
-    bvr_memstream_seek(&book->asset_stream, 0, SEEK_SET);
-    while (book->asset_stream.cursor < prev_cursor)
-    {
-        // skip uuid
-        book->asset_stream.cursor += sizeof(bvr_uuid_t);
-
-        string_length = *((uint16*)book->asset_stream.cursor);
-
-        if(!strncmp(book->asset_stream.cursor + sizeof(unsigned short), path, string_length)){
-            uuid = (bvr_uuid_t*)book->asset_stream.cursor;
-            if(asset == NULL){
-                return uuid;
-            }
+    return bvr_find_asset_atom(bvr_find_atom(path), asset);
+}
 
-            memcpy(&asset->id, book->asset_stream.cursor - sizeof(bvr_uuid_t), sizeof(bvr_uuid_t));
-            asset->path.length = string_length;
-            asset->path.string = book->asset_stream.cursor + sizeof(unsigned short);
-            
-            book->asset_stream.cursor += string_length;
-            asset->open_mode = *book->asset_stream.cursor;
-            return uuid;
-        }
+bvr_uuid_t* bvr_find_asset_atom(const bvr_atom_t path, bvr_asset_t* asset){
+    if(path == BVR_NULL_ATOM){
+        return NULL;
+    }
 
-        book->asset_stream.cursor += string_length;
+    bvr_book_t* book = bvr_get_instance();
+    char* record = bvr_hashmap_find(&book->asset_index, path);
 
-        // go to the end
-        bvr_memstream_seek(&book->asset_stream, sizeof(uint16) + sizeof(char), SEEK_CUR);
+    if(record && asset){
+        bvri_decode_asset_record(record, asset);
     }
-    
-    return uuid;
+
+    return (bvr_uuid_t*)record;
 }
 
 int bvr_find_asset_uuid(const bvr_uuid_t uuid, bvr_asset_t* asset){
@@ -116,35 +159,29 @@ int bvr_find_asset_uuid(const bvr_uuid_t uuid, bvr_asset_t* asset){
 
     bvr_book_t* book = bvr_get_instance();
 
-    uint16 string_length;
-    bvr_uuid_t other;
-    const char* prev_cursor = book->asset_stream.cursor;
+    char* record;
+    uint32 iterator = 0;
 
-    while (book->asset_stream.cursor < prev_cursor)
+    while ((record = bvr_hashmap_next(&book->asset_uuid_index, bvr_uuid_hash(uuid), &iterator)))
     {
-        bvr_memstream_read(&book->asset_stream, &other, sizeof(bvr_uuid_t));
-
-        if(bvr_uuid_equals(other, uuid)){
-            
-            string_length = *((uint16*)book->asset_stream.cursor);
-            asset->path.length = string_length;
-            asset->path.string = book->asset_stream.cursor + sizeof(unsigned short);
-            
-            book->asset_stream.cursor += string_length;
-            asset->open_mode = *book->asset_stream.cursor;
+        bvri_decode_asset_record(record, asset);
 
+        if(bvr_uuid_equals(asset->id, uuid)){
             return BVR_TRUE;
         }
-
-        book->asset_stream.cursor += sizeof(bvr_uuid_t);
-        string_length = *((uint16*)book->asset_stream.cursor);
-
-        bvr_memstream_seek(&book->asset_stream, sizeof(uint16) + sizeof(char) + string_length, SEEK_CUR);
     }
     
     return BVR_FALSE;
 }
 
+void bvr_clear_assets(void){
+    bvr_book_t* book = bvr_get_instance();
+
+    bvr_memstream_clear(&book->asset_stream);
+    bvr_hashmap_clear(&book->asset_index);
+    bvr_hashmap_clear(&book->asset_uuid_index);
+}
+
 #pragma endregion
 
 #pragma region write
@@ -164,6 +201,17 @@ static void bvri_write_string(FILE* file, bvr_string_t* string){
     }
 }
 
+/*
+    Atoms are written as strings, so that they do not depend on the interning order.
+*/
+static void bvri_write_atom(FILE* file, const bvr_atom_t atom){
+    bvr_string_t string;
+    string.string = (char*)bvr_atom_string(atom);
+    string.length = string.string ? bvr_atom_length(atom) + 1 : 0;
+
+    bvri_write_string(file, &string);
+}
+
 static void bvri_write_asset_reference(FILE* file, struct bvr_asset_reference_s* asset){
     fwrite(&asset->origin, sizeof(enum bvr_asset_reference_origin_e), 1, file);
     switch (asset->origin)
@@ -214,14 +262,14 @@ void bvr_write_book_dataf(FILE* file, bvr_book_t* book){
     uint32 bin_offset = 0;
     // write asset informaions
     {
-        uint32 stream_size = book->asset_stream.next - (char*)book->asset_stream.data;
+        uint32 stream_size = book->asset_stream.length;
         uint16 asset_flag = BVR_EDITOR_ASSETS;
         bin_offset = 0;
 
         fwrite(&stream_size, sizeof(uint32), 1, file);
         fwrite(&asset_flag, sizeof(uint16), 1, file);
         fwrite(&bin_offset, sizeof(uint32), 1, file);
-        fwrite(book->asset_stream.data, stream_size, 1, file);
+        bvr_memstream_fwrite(&book->asset_stream, file);
     }
 
     // write page informations
@@ -264,7 +312,7 @@ void bvr_write_book_dataf(FILE* file, bvr_book_t* book){
             uint32 size;
             uint32 offset;
 
-            bvr_string_t name;
+            bvr_atom_t name;
             bvr_actor_type_t type;
 
             bvr_uuid_t id;
@@ -276,11 +324,7 @@ void bvr_write_book_dataf(FILE* file, bvr_book_t* book){
         } target;
 
         struct bvr_actor_s* actor = NULL;
-        BVR_POOL_FOR_EACH(actor, book->page.actors){
-            if(actor == NULL){
-                break;
-            }
-
+        BVR_SLOTMAP_FOR_EACH(actor, book->page.actors){
             target.size = 0;
             target.offset = 0;
             target.type = actor->type;
@@ -290,13 +334,13 @@ void bvr_write_book_dataf(FILE* file, bvr_book_t* book){
             
             memcpy(&target.transform, &actor->transform, sizeof(bvr_transform_t));
             memcpy(&target.id, &actor->id, sizeof(bvr_uuid_t));
-            bvr_string_create_and_copy(&target.name, &actor->name);
+            target.name = actor->name;
 
             size_offset = ftell(file);
             fwrite(&target.size, sizeof(uint32), 1, file);
             fwrite(&target.offset, sizeof(uint32), 1, file);
 
-            bvri_write_string(file, &target.name);
+            bvri_write_atom(file, target.name);
             
             fwrite(&target.type, sizeof(bvr_actor_type_t), 1, file);
             fwrite(&target.id, sizeof(bvr_uuid_t), 1, file);
@@ -340,14 +384,14 @@ void bvr_write_book_dataf(FILE* file, bvr_book_t* book){
                     fwrite(&landscape->dimension, sizeof(landscape->dimension), 1, file);
                     fwrite(&landscape_byte_length, sizeof(uint32), 1, file);
                     
-                    glBindBuffer(GL_ARRAY_BUFFER, landscape->mesh.vertex_buffer);
+                    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, landscape->mesh.vertex_buffer);
                     int* map = glMapBufferRange(GL_ARRAY_BUFFER, 0, landscape_byte_length, GL_MAP_READ_BIT);
                     
                     if(map){
                         fwrite(map, sizeof(char), landscape_byte_length, file);
                         
                         glUnmapBuffer(GL_ARRAY_BUFFER);
-                        glBindBuffer(GL_ARRAY_BUFFER, 0);
+                        bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
                     }
                 }
             default:
@@ -366,9 +410,6 @@ void bvr_write_book_dataf(FILE* file, bvr_book_t* book){
             fseek(file, section_start, SEEK_SET);
             fwrite(&section_size, sizeof(uint32), 1, file);
             fseek(file, prev_offset, SEEK_SET);
-            
-            // free elements
-            bvr_destroy_string(&target.name);
         }
     }
 
@@ -388,6 +429,19 @@ static void bvri_read_string(FILE* file, bvr_string_t* string){
     bvr_overwrite_string(string, buffer, length);
 }
 
+static bvr_atom_t bvri_read_atom(FILE* file){
+    char buffer[BVR_BUFFER_SIZE];
+    uint16 length = bvr_freadu16_le(file);
+    BVR_ASSERT(length < BVR_BUFFER_SIZE);
+
+    if(!length){
+        return BVR_NULL_ATOM;
+    }
+
+    fread(buffer, sizeof(char), length, file);
+    return bvr_intern_n(buffer, strnlen(buffer, length));
+}
+
 static void bvri_read_chunk(FILE* file, struct bvri_chunk_data_s* chunk, void* object){
     BVR_ASSERT(object);
     BVR_ASSERT(chunk);
@@ -444,17 +498,16 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
 
         BVR_ASSERT(asset_flag == BVR_EDITOR_ASSETS);
 
-        // detroy current asset stream
-        if(!book->asset_stream.data || book->asset_stream.size < section_size){
-            bvr_destroy_memstream(&book->asset_stream);
-            bvr_create_memstream(&book->asset_stream, section_size);
-        }
-        else {
-            bvr_memstream_clear(&book->asset_stream);
-        }
+        // clear current asset stream
+        bvr_memstream_clear(&book->asset_stream);
 
         // copy previously saved asset data stream into the asset stream
-        fread(book->asset_stream.data, sizeof(char), section_size, file);
+        if(section_size){
+            char* section = bvr_memstream_write(&book->asset_stream, NULL, section_size);
+            fread(section, sizeof(char), section_size, file);
+        }
+
+        bvri_index_assets(book);
     }
 
     // read page informations
@@ -496,7 +549,7 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
             uint32 size;
             uint32 offset;
 
-            bvr_string_t name;
+            bvr_atom_t name;
             bvr_actor_type_t type;
 
             bvr_uuid_t id;
@@ -511,7 +564,7 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
 
         BVR_ASSERT(actor_flag == BVR_EDITOR_ACTOR);
 
-        target_data.name.string = NULL;
+        target_data.name = BVR_NULL_ATOM;
 
         // while this section isn't finished
         while (readed_bytes < section_size)
@@ -521,7 +574,7 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
 
 
             // read binary data
-            bvri_read_string(file, &target_data.name);
+            target_data.name = bvri_read_atom(file);
 
             target_data.type = bvr_fread32_le(file);
             fread(&target_data.id, sizeof(bvr_uuid_t), 1, file);
@@ -533,8 +586,9 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
 
             struct bvr_actor_s* target = bvr_find_actor_uuid(book, target_data.id);
             if(target){
-                bvr_destroy_string(&target->name);
-                bvr_string_create_and_copy(&target->name, &target_data.name);
+                bvr_unindex_actor(&book->page, target);
+                target->name = target_data.name;
+                bvr_index_actor(&book->page, target);
 
                 target->type = target_data.type;
                 target->flags = target_data.flags;
@@ -542,6 +596,7 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
                 target->order_in_layer = target_data.order_in_layer;
 
                 memcpy(&target->transform, &target_data.transform, sizeof(bvr_transform_t));
+                bvr_set_actor_dirty(target);
             }
 
              // actor overwrite 
@@ -588,7 +643,7 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
                     landscape_bytes_length = MIN(landscape_bytes_length, landscape->mesh.vertex_count * sizeof(int));
                     
                     if(landscape->mesh.array_buffer && landscape->mesh.vertex_buffer){
-                        glBindBuffer(GL_ARRAY_BUFFER, landscape->mesh.vertex_buffer);
+                        bvr_gl_bind_buffer(GL_ARRAY_BUFFER, landscape->mesh.vertex_buffer);
                         int* map = glMapBufferRange(GL_ARRAY_BUFFER, 0, landscape_bytes_length, GL_MAP_WRITE_BIT);
                         
                         if(map){
@@ -597,7 +652,7 @@ void bvr_open_book_dataf(FILE* file, bvr_book_t* book){
                             glUnmapBuffer(GL_ARRAY_BUFFER);
                         }
 
-                        glBindBuffer(GL_ARRAY_BUFFER, 0);
+                        bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
                     }
 
                 }
@@ -1,91 +1,211 @@
 #include <BVR/buffer.h>
 #include <BVR/common.h>
+#include <BVR/math.h>
 
 #include <malloc.h>
 #include <string.h>
 
 #ifndef BVR_NO_GROWTH
+    #define BVR_GROWTH_FACTOR 2
+#endif
 
-#define BVR_GROWTH_FACTOR 2
+#define BVRI_PAGE_DATA(page) ((char*)((struct bvr_memstream_page_s*)(page) + 1))
 
-static int bvri_grow_buffer(void* ptr, uint64* size);
+static struct bvr_memstream_page_s* bvri_create_memstream_page(const uint64 size){
+    struct bvr_memstream_page_s* page = malloc(sizeof(struct bvr_memstream_page_s) + size);
+    BVR_ASSERT(page);
 
-static int bvri_grow_buffer(void* ptr, uint64* size){
-    if(ptr && size){
-        ptr = realloc(ptr, (*size *= BVR_GROWTH_FACTOR));
-        return ptr != NULL;
-    }
+    page->next = NULL;
+    page->size = size;
+    page->used = 0;
 
-    return 0;
+    memset(BVRI_PAGE_DATA(page), 0, size);
+    return page;
 }
 
+/*
+    Get a page that can contain `size` more bytes, 
+    reuse empty pages before appending a new one.
+*/
+static struct bvr_memstream_page_s* bvri_memstream_reserve_page(bvr_memstream_t* stream, const uint64 size){
+    struct bvr_memstream_page_s* page = stream->last;
+
+    while (page)
+    {
+        if(page->size - page->used >= size){
+            return page;
+        }
+
+        if(!page->next){
+            break;
+        }
+
+        page = page->next;
+    }
+
+    // each new page is bigger than the previous one
+    uint64 page_size = BVR_MEMSTREAM_PAGE_SIZE;
+    if(page){
+        page_size = page->size;
+
+#ifndef BVR_NO_GROWTH
+        page_size = MIN(page_size * BVR_GROWTH_FACTOR, BVR_MEMSTREAM_MAX_PAGE_SIZE);
 #endif
+    }
+
+    struct bvr_memstream_page_s* new_page = bvri_create_memstream_page(MAX(page_size, size));
+    
+    if(page){
+        page->next = new_page;
+    }
+    else {
+        stream->pages = new_page;
+    }
+
+    stream->size += new_page->size;
+    return new_page;
+}
 
-void bvr_create_memstream(bvr_memstream_t* stream, unsigned long long const size){
+/*
+    Move the cursor to the next page if it reached the end of the current page.
+*/
+static void bvri_memstream_normalize(bvr_memstream_t* stream){
+    while (stream->page && stream->position < stream->length &&
+        stream->cursor == BVRI_PAGE_DATA(stream->page) + stream->page->used)
+    {
+        stream->page = stream->page->next;
+        stream->cursor = BVRI_PAGE_DATA(stream->page);
+    }
+}
+
+/*
+    Move the cursor forward inside the written data, copy or overwrite data if asked.
+    Returns the number of bytes the cursor moved.
+*/
+static uint64 bvri_memstream_advance(bvr_memstream_t* stream, void* dest, const void* src, uint64 size){
+    uint64 moved = 0;
+    
+    while (moved < size && stream->position < stream->length)
+    {
+        bvri_memstream_normalize(stream);
+
+        const uint64 available = stream->page->used - (stream->cursor - BVRI_PAGE_DATA(stream->page));
+        const uint64 count = MIN(available, size - moved);
+
+        if(dest){
+            memcpy((char*)dest + moved, stream->cursor, count);
+        }
+        if(src){
+            memcpy(stream->cursor, (const char*)src + moved, count);
+        }
+
+        stream->cursor += count;
+        stream->position += count;
+        moved += count;
+    }
+
+    return moved;
+}
+
+void bvr_create_memstream(bvr_memstream_t* stream, const uint64 size){
     BVR_ASSERT(stream);
 
-    if(stream->data){
+    if(stream->pages){
         return;
     }
 
-    stream->data = NULL;
-    stream->size = size;
+    stream->pages = NULL;
+    stream->last = NULL;
+    stream->page = NULL;
     stream->cursor = NULL;
+    stream->position = 0;
+    stream->length = 0;
+    stream->size = 0;
 
     if(size){
-        stream->data = malloc(size);
-        stream->cursor = stream->data;
-        stream->next = stream->data;
-        BVR_ASSERT(stream->data);
-
-        memset(stream->data, 0, stream->size);
+        stream->pages = bvri_create_memstream_page(size);
+        stream->last = stream->pages;
+        stream->page = stream->pages;
+        stream->cursor = BVRI_PAGE_DATA(stream->pages);
+        stream->size = size;
     }
 }
 
 char* bvr_memstream_write(bvr_memstream_t* stream, const void* data, const uint64 size){
-    BVR_ASSERT(stream && stream->data);
+    BVR_ASSERT(stream);
 
-    if(stream->cursor - (char*)stream->data + size < stream->size){
-        if(data){
-            memcpy(stream->cursor, data, size);
-        }
+    char* block = NULL;
+    uint64 written = 0;
 
-        stream->cursor += size;
-        stream->next += size;
+    if(!size){
+        return stream->cursor;
     }
-    else {
 
-#ifndef BVR_NO_GROWTH
-        if(stream->cursor - (char*)stream->data + size < stream->size * BVR_GROWTH_FACTOR){
-            bvri_grow_buffer(stream->data, &stream->size);
-            
-            if(data){
-                memcpy(stream->cursor, data, size);
-            }
-            
-            stream->cursor += size;
-            stream->next += size;
-        }
-        else {
-            BVR_ASSERT(0 || "out of bounds!");
+    // overwrite already written data
+    if(stream->position < stream->length){
+        bvri_memstream_normalize(stream);
+        block = stream->cursor;
 
+        written = bvri_memstream_advance(stream, NULL, data, size);
+        if(written == size){
+            return block;
         }
-#else
-        BVR_ASSERT(0 || "out of bounds!");
-#endif
+    }
 
+    // append data at the end of the stream
+    struct bvr_memstream_page_s* page = bvri_memstream_reserve_page(stream, size - written);
+    char* end = BVRI_PAGE_DATA(page) + page->used;
+
+    if(data){
+        memcpy(end, (const char*)data + written, size - written);
+    }
+    else {
+        memset(end, 0, size - written);
     }
 
-    return stream->cursor;
+    page->used += size - written;
+    stream->length += size - written;
+    stream->position = stream->length;
+    
+    stream->last = page;
+    stream->page = page;
+    stream->cursor = end + (size - written);
+
+    if(!block){
+        block = end;
+    }
+
+    return block;
+}
+
+char* bvr_memstream_alloc(bvr_memstream_t* stream, const uint64 size, const uint64 alignment){
+    BVR_ASSERT(stream);
+    BVR_ASSERT(alignment && (alignment & (alignment - 1)) == 0);
+
+    // reserve enough space for the worst padding
+    struct bvr_memstream_page_s* page = bvri_memstream_reserve_page(stream, size + alignment - 1);
+    char* end = BVRI_PAGE_DATA(page) + page->used;
+    const uint64 padding = (alignment - ((uint64)end & (alignment - 1))) & (alignment - 1);
+
+    memset(end, 0, padding + size);
+
+    page->used += padding + size;
+    stream->length += padding + size;
+    stream->position = stream->length;
+
+    stream->last = page;
+    stream->page = page;
+    stream->cursor = end + padding + size;
+
+    return end + padding;
 }
 
 char* bvr_memstream_read(bvr_memstream_t* stream, void* dest, const uint64 size){
-    BVR_ASSERT(stream && stream->data);
+    BVR_ASSERT(stream);
     BVR_ASSERT(dest);
 
-    if(stream->cursor - (char*)stream->data + size < stream->size){
-        memcpy(dest, stream->cursor, size);
-        stream->cursor += size;
+    if(stream->position + size <= stream->length){
+        bvri_memstream_advance(stream, dest, NULL, size);
     }
     else {
         BVR_ASSERT(0 || "out of bounds!");
@@ -94,6 +214,22 @@ char* bvr_memstream_read(bvr_memstream_t* stream, void* dest, const uint64 size)
     return stream->cursor;
 }
 
+char* bvr_memstream_peek(bvr_memstream_t* stream, const uint64 size){
+    BVR_ASSERT(stream);
+
+    if(stream->position + size > stream->length){
+        return NULL;
+    }
+
+    bvri_memstream_normalize(stream);
+
+    if(stream->cursor + size <= BVRI_PAGE_DATA(stream->page) + stream->page->used){
+        return stream->cursor;
+    }
+
+    return NULL;
+}
+
 char* bvr_memstream_seek(bvr_memstream_t* stream, uint64 position, int mode){
     BVR_ASSERT(stream);
 
@@ -101,8 +237,8 @@ char* bvr_memstream_seek(bvr_memstream_t* stream, uint64 position, int mode){
     {
     case SEEK_CUR:
         {
-            if(stream->cursor - (char*)stream->data + position < stream->size){
-                stream->cursor += position;
+            if(stream->position + position <= stream->length){
+                bvri_memstream_advance(stream, NULL, NULL, position);
             } 
             else {
                 BVR_ASSERT(0 || "out of bounds!");
@@ -110,10 +246,10 @@ char* bvr_memstream_seek(bvr_memstream_t* stream, uint64 position, int mode){
         }
         break;
 
-    case SEEK_SET:
+    case SEEK_END:
         {
-            if(position <= stream->size){
-                stream->cursor = stream->data + position;
+            if(position <= stream->length){
+                return bvr_memstream_seek(stream, stream->length - position, SEEK_SET);
             }
             else {
                 BVR_ASSERT(0 || "out of bounds!");
@@ -121,10 +257,14 @@ char* bvr_memstream_seek(bvr_memstream_t* stream, uint64 position, int mode){
         }
         break;
 
-    case SEEK_END:
+    case SEEK_SET:
         {
-            if(position <= stream->size){
-                stream->cursor = stream->data + (stream->size - position);
+            if(position <= stream->length){
+                stream->page = stream->pages;
+                stream->cursor = stream->pages ? BVRI_PAGE_DATA(stream->pages) : NULL;
+                stream->position = 0;
+
+                bvri_memstream_advance(stream, NULL, NULL, position);
             }
             else {
                 BVR_ASSERT(0 || "out of bounds!");
@@ -134,7 +274,9 @@ char* bvr_memstream_seek(bvr_memstream_t* stream, uint64 position, int mode){
 
     case SEEK_NEXT:
         {
-            stream->cursor = stream->next;
+            stream->page = stream->last;
+            stream->cursor = stream->last ? BVRI_PAGE_DATA(stream->last) + stream->last->used : NULL;
+            stream->position = stream->length;
         }
         break;
 
@@ -149,24 +291,196 @@ char* bvr_memstream_seek(bvr_memstream_t* stream, uint64 position, int mode){
 void bvr_memstream_clear(bvr_memstream_t* stream){
     BVR_ASSERT(stream);
 
-    stream->cursor = stream->data;
-    stream->next = stream->data;
-    memset(stream->data, 0, stream->size);
+    for (struct bvr_memstream_page_s* page = stream->pages; page; page = page->next)
+    {
+        memset(BVRI_PAGE_DATA(page), 0, page->used);
+        page->used = 0;
+    }
+
+    stream->last = stream->pages;
+    stream->page = stream->pages;
+    stream->cursor = stream->pages ? BVRI_PAGE_DATA(stream->pages) : NULL;
+    stream->position = 0;
+    stream->length = 0;
+}
+
+uint64 bvr_memstream_fwrite(bvr_memstream_t* stream, FILE* file){
+    BVR_ASSERT(stream);
+    BVR_ASSERT(file);
+
+    uint64 written = 0;
+    for (struct bvr_memstream_page_s* page = stream->pages; page; page = page->next)
+    {
+        if(page->used){
+            written += fwrite(BVRI_PAGE_DATA(page), sizeof(char), page->used, file);
+        }
+    }
+
+    return written;
 }
 
 void bvr_destroy_memstream(bvr_memstream_t* stream){
     BVR_ASSERT(stream);
 
-    // clear all stream data
-    // so that it will be an empty chunk if we're trying to access
-    // to the stream's data after it has been freed.
-    memset(stream->data, 0, stream->size);
+    struct bvr_memstream_page_s* page = stream->pages;
+    struct bvr_memstream_page_s* next = NULL;
 
-    free(stream->data);
+    while (page)
+    {
+        next = page->next;
+        free(page);
+        page = next;
+    }
 
-    stream->size = 0;
+    stream->pages = NULL;
+    stream->last = NULL;
+    stream->page = NULL;
     stream->cursor = NULL;
-    stream->data = NULL;
+    stream->position = 0;
+    stream->length = 0;
+    stream->size = 0;
+}
+
+static void bvri_free_arena_blocks(bvr_arena_t* arena){
+    struct bvr_arena_block_s* block = arena->overflow;
+    struct bvr_arena_block_s* next = NULL;
+
+    while (block)
+    {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->overflow = NULL;
+}
+
+void bvr_create_arena(bvr_arena_t* arena, const uint64 size){
+    BVR_ASSERT(arena);
+
+    arena->data = NULL;
+    arena->size = size;
+    arena->offset = 0;
+    arena->used = 0;
+    arena->peak = 0;
+    arena->overflow = NULL;
+
+    if(size){
+        arena->data = malloc(size);
+        BVR_ASSERT(arena->data);
+    }
+}
+
+void* bvr_arena_alloc(bvr_arena_t* arena, const uint64 size, const uint64 alignment){
+    BVR_ASSERT(arena);
+    BVR_ASSERT(alignment && (alignment & (alignment - 1)) == 0);
+
+    // align the offset relative to the address
+    uint64 offset = ((uint64)(arena->data + arena->offset) + (alignment - 1)) & ~(alignment - 1);
+    offset -= (uint64)arena->data;
+
+    if(arena->data && offset + size <= arena->size){
+        arena->used += offset - arena->offset + size;
+        arena->offset = offset + size;
+        
+        return arena->data + offset;
+    }
+
+    // budget is exceeded, try to use the last overflow block
+    struct bvr_arena_block_s* block = arena->overflow;
+    if(block){
+        char* base = (char*)(block + 1);
+
+        offset = ((uint64)(base + block->offset) + (alignment - 1)) & ~(alignment - 1);
+        offset -= (uint64)base;
+
+        if(offset + size <= block->size){
+            arena->used += offset - block->offset + size;
+            block->offset = offset + size;
+
+            return base + offset;
+        }
+    }
+
+    // allocate a new overflow block
+    const uint64 block_size = MAX(size + alignment, arena->size);
+    block = malloc(sizeof(struct bvr_arena_block_s) + block_size);
+    BVR_ASSERT(block);
+
+    block->next = arena->overflow;
+    block->size = block_size;
+    block->offset = 0;
+    arena->overflow = block;
+
+    char* base = (char*)(block + 1);
+    offset = ((uint64)base + (alignment - 1)) & ~(alignment - 1);
+    offset -= (uint64)base;
+
+    block->offset = offset + size;
+    arena->used += block->offset;
+
+    return base + offset;
+}
+
+void bvr_arena_reset(bvr_arena_t* arena){
+    BVR_ASSERT(arena);
+
+    arena->peak = MAX(arena->peak, arena->used);
+
+    // if there was an overflow, grow the arena so that next time everything fits
+    if(arena->overflow){
+        bvri_free_arena_blocks(arena);
+
+        free(arena->data);
+        arena->size = MAX(arena->size, arena->peak);
+
+#ifndef BVR_NO_GROWTH
+        arena->size *= BVR_GROWTH_FACTOR;
+#endif
+
+        arena->data = malloc(arena->size);
+        BVR_ASSERT(arena->data);
+
+        BVR_PRINTF("arena budget exceeded, growing to %llu bytes", arena->size);
+    }
+
+    arena->offset = 0;
+    arena->used = 0;
+}
+
+void bvr_destroy_arena(bvr_arena_t* arena){
+    BVR_ASSERT(arena);
+
+    bvri_free_arena_blocks(arena);
+    free(arena->data);
+
+    arena->data = NULL;
+    arena->size = 0;
+    arena->offset = 0;
+    arena->used = 0;
+    arena->peak = 0;
+}
+
+void bvr_create_frame_arena(bvr_frame_arena_t* arena, const uint64 size){
+    BVR_ASSERT(arena);
+
+    bvr_create_arena(&arena->arenas[0], size);
+    bvr_create_arena(&arena->arenas[1], size);
+    arena->current = 0;
+}
+
+void bvr_frame_arena_swap(bvr_frame_arena_t* arena){
+    BVR_ASSERT(arena);
+
+    arena->current = !arena->current;
+    bvr_arena_reset(&arena->arenas[arena->current]);
+}
+
+void bvr_destroy_frame_arena(bvr_frame_arena_t* arena){
+    BVR_ASSERT(arena);
+
+    bvr_destroy_arena(&arena->arenas[0]);
+    bvr_destroy_arena(&arena->arenas[1]);
 }
 
 void bvr_create_string(bvr_string_t* string, const char* value){
@@ -286,118 +600,511 @@ void bvr_destroy_string(bvr_string_t* string){
     string->length = 0;
 }
 
-void bvr_create_pool(bvr_pool_t* pool, const uint64 size, const uint64 count){
-    BVR_ASSERT(pool);
-    
-    pool->data = NULL;
-    pool->next_block = NULL;
-    pool->avail = NULL;
+void bvr_create_slotmap(bvr_slotmap_t* map, const uint64 size, const uint64 count){
+    BVR_ASSERT(map);
+    BVR_ASSERT(size);
 
-    pool->capacity = count + 1;
-    pool->size = (size + sizeof(struct bvr_pool_block_u)) * pool->capacity;
-    pool->elemsize = size;
-    pool->count = 0;
+    map->elemsize = size;
+    map->capacity = count;
+    map->count = 0;
+    map->peak = 0;
+    map->free_slot = BVR_INVALID_INDEX;
 
-    // allocate enough space for the linked list and raw memory space
-    pool->data = malloc(pool->size);
-    BVR_ASSERT(pool->data);
+    map->data = NULL;
+    map->slots = NULL;
+    map->owners = NULL;
 
-    pool->next_block = (void*)pool->data;
-    pool->blocks = (void*)pool->data;
-    pool->avail = &pool->data[pool->capacity * sizeof(struct bvr_pool_block_u)];
+    if(!count){
+        return;
+    }
 
-    // link all chunk together
-    for (size_t i = 0; i < pool->capacity; i++)
-    {
-        pool->blocks[i].data = NULL;
-        pool->blocks[i].next = &pool->blocks[i + 1];
+    map->data = malloc(map->elemsize * map->capacity);
+    map->slots = malloc(sizeof(struct bvr_slot_s) * map->capacity);
+    map->owners = malloc(sizeof(uint32) * map->capacity);
+    BVR_ASSERT(map->data && map->slots && map->owners);
+
+    memset(map->slots, 0, sizeof(struct bvr_slot_s) * map->capacity);
+    bvr_slotmap_clear(map);
+}
+
+int bvr_slotmap_reserve(bvr_slotmap_t* map, const uint64 count){
+    BVR_ASSERT(map);
+
+    if(count <= map->capacity){
+        return BVR_TRUE;
+    }
+
+    if(count >= BVR_INVALID_INDEX){
+        BVR_PRINT("slot map is too big!");
+        return BVR_FALSE;
+    }
+
+    char* data = realloc(map->data, map->elemsize * count);
+    struct bvr_slot_s* slots = realloc(map->slots, sizeof(struct bvr_slot_s) * count);
+    uint32* owners = realloc(map->owners, sizeof(uint32) * count);
+
+    // keep succeeded reallocations, previous blocks are already freed
+    if(data) map->data = data;
+    if(slots) map->slots = slots;
+    if(owners) map->owners = owners;
+
+    if(!data || !slots || !owners){
+        BVR_PRINT("failed to grow slot map!");
+        return BVR_FALSE;
     }
 
-    pool->blocks[pool->capacity - 1].next = NULL;
+    // link new slots in front of the free list, lowest index first
+    for (uint32 i = count; i > map->capacity; i--)
+    {
+        struct bvr_slot_s* slot = &map->slots[i - 1];
+        slot->generation = 1;
+        slot->dense = map->free_slot;
+        map->free_slot = i - 1;
+    }
+    
+    map->capacity = count;
+    return BVR_TRUE;
 }
 
-void* bvr_pool_alloc(bvr_pool_t* pool){
-    BVR_ASSERT(pool);
+void* bvr_slotmap_alloc(bvr_slotmap_t* map, bvr_handle_t* handle){
+    BVR_ASSERT(map);
 
-    // check if a next block is available and if data can be added
-    if(pool->next_block == NULL || 
-        pool->avail + pool->elemsize >= pool->data + pool->size){
+    if(map->free_slot == BVR_INVALID_INDEX){
+#ifndef BVR_NO_GROWTH
+        if(!bvr_slotmap_reserve(map, MAX((uint64)map->capacity * BVR_GROWTH_FACTOR, 8))){
+            return NULL;
+        }
+#else
         return NULL;
+#endif
     }
 
-    struct bvr_pool_block_u* block = pool->next_block;
-    pool->next_block = pool->next_block->next;
+    // pop the next free slot
+    const uint32 index = map->free_slot;
+    struct bvr_slot_s* slot = &map->slots[index];
+    map->free_slot = slot->dense;
 
-    block->data = pool->avail;
-    pool->avail += pool->elemsize;
+    // element is always pushed at the end of the dense array
+    slot->dense = map->count;
+    map->owners[map->count] = index;
+    map->count++;
+    map->peak = MAX(map->peak, map->count);
 
-    pool->count++;
-    return block->data;
+    if(handle){
+        handle->index = index;
+        handle->generation = slot->generation;
+    }
+
+    return map->data + (uint64)slot->dense * map->elemsize;
 }
 
-void* bvr_pool_try_get(bvr_pool_t* pool, int index){
-    BVR_ASSERT(pool);
-    
-    if(index < 0 && index >= pool->count){
+void* bvr_slotmap_get(bvr_slotmap_t* map, bvr_handle_t handle){
+    if(!bvr_slotmap_is_valid(map, handle)){
         return NULL;
     }
-    
-    return pool->blocks[index].data;
+
+    return map->data + (uint64)map->slots[handle.index].dense * map->elemsize;
 }
 
-void bvr_pool_free(bvr_pool_t* pool, void* ptr){
-    BVR_ASSERT(pool);
+bvr_handle_t bvr_slotmap_handle_at(bvr_slotmap_t* map, uint32 index){
+    BVR_ASSERT(map);
 
-    if(ptr == NULL) {
-        return;
+    bvr_handle_t handle;
+    handle.index = BVR_INVALID_INDEX;
+    handle.generation = 0;
+
+    if(index < map->count){
+        handle.index = map->owners[index];
+        handle.generation = map->slots[handle.index].generation;
+    }
+
+    return handle;
+}
+
+int bvr_slotmap_free(bvr_slotmap_t* map, bvr_handle_t handle){
+    BVR_ASSERT(map);
+
+    if(!bvr_slotmap_is_valid(map, handle)){
+        return BVR_FALSE;
     }
 
-    // set current block as free 
-    // and push it as the next allocated block
-    struct bvr_pool_block_u* block = (struct bvr_pool_block_u*)ptr;
-    uint32 index = ((char*)block - pool->data) / sizeof(struct bvr_pool_block_u);
+    struct bvr_slot_s* slot = &map->slots[handle.index];
+    const uint32 last = map->count - 1;
 
-    if(index){      
-        memmove(block->data, block->data + pool->elemsize, 
-            (pool->capacity - index - 1) * pool->elemsize
+    // move the last element into the hole to keep the dense array packed
+    if(slot->dense != last){
+        memcpy(
+            map->data + (uint64)slot->dense * map->elemsize, 
+            map->data + (uint64)last * map->elemsize, 
+            map->elemsize
         );
 
-        // remap 
-        for (struct bvr_pool_block_u* b = &pool->blocks[index]; b->next; b++)
+        map->owners[slot->dense] = map->owners[last];
+        map->slots[map->owners[last]].dense = slot->dense;
+    }
+
+    map->count--;
+
+    // invalidate every handle that points to this slot, 
+    // generation 0 is never used so that a zeroed handle is always stale
+    slot->generation++;
+    if(slot->generation == 0){
+        slot->generation = 1;
+    }
+
+    slot->dense = map->free_slot;
+    map->free_slot = handle.index;
+
+    return BVR_TRUE;
+}
+
+void bvr_slotmap_clear(bvr_slotmap_t* map){
+    BVR_ASSERT(map);
+
+    map->count = 0;
+    map->free_slot = BVR_INVALID_INDEX;
+
+    // link all slots together, 
+    // the first slot is the first being allocated
+    for (uint32 i = map->capacity; i > 0; i--)
+    {
+        struct bvr_slot_s* slot = &map->slots[i - 1];
+        
+        // keep generations so that handles from before stay stale
+        slot->generation++;
+        if(slot->generation == 0){
+            slot->generation = 1;
+        }
+
+        slot->dense = map->free_slot;
+        map->free_slot = i - 1;
+    }
+}
+
+void bvr_destroy_slotmap(bvr_slotmap_t* map){
+    BVR_ASSERT(map);
+
+    free(map->data);
+    free(map->slots);
+    free(map->owners);
+
+    map->data = NULL;
+    map->slots = NULL;
+    map->owners = NULL;
+    map->free_slot = BVR_INVALID_INDEX;
+    map->count = 0;
+    map->capacity = 0;
+    map->peak = 0;
+}
+
+/*
+    Mix key's bits so that sequential keys do not cluster. 
+*/
+static uint64 bvri_hash_key(uint64 key){
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+static void bvri_hashmap_rehash(bvr_hashmap_t* map, uint32 capacity){
+    struct bvr_hashmap_entry_s* entries = map->entries;
+    const uint32 prev_capacity = map->capacity;
+
+    map->entries = calloc(capacity, sizeof(struct bvr_hashmap_entry_s));
+    BVR_ASSERT(map->entries);
+
+    map->capacity = capacity;
+    map->count = 0;
+    map->tombstones = 0;
+
+    for (uint32 i = 0; i < prev_capacity; i++)
+    {
+        if(entries[i].value && entries[i].value != BVR_HASHMAP_TOMBSTONE){
+            bvr_hashmap_insert(map, entries[i].key, entries[i].value);
+        }
+    }
+
+    free(entries);
+}
+
+void bvr_create_hashmap(bvr_hashmap_t* map, const uint64 count){
+    BVR_ASSERT(map);
+
+    map->entries = NULL;
+    map->count = 0;
+    map->tombstones = 0;
+    map->capacity = 0;
+
+    if(count){
+        uint32 capacity = 8;
+        while (capacity < count)
         {
-            if(b->data){
-                b->data -= pool->elemsize;
-            }
+            capacity <<= 1;
+        }
+
+        bvri_hashmap_rehash(map, capacity);
+    }
+}
+
+int bvr_hashmap_insert(bvr_hashmap_t* map, const uint64 key, void* value){
+    BVR_ASSERT(map);
+
+    if(!value){
+        return BVR_FALSE;
+    }
+
+    // keep load factor under 3/4
+    if((map->count + map->tombstones + 1) * 4 > map->capacity * 3){
+        uint32 capacity = map->capacity ? map->capacity : 8;
+        if((map->count + 1) * 2 > capacity){
+            capacity <<= 1;
+        }
+
+        bvri_hashmap_rehash(map, capacity);
+    }
+
+    const uint32 mask = map->capacity - 1;
+    uint32 index = bvri_hash_key(key) & mask;
+
+    while (map->entries[index].value && map->entries[index].value != BVR_HASHMAP_TOMBSTONE)
+    {
+        index = (index + 1) & mask;
+    }
+
+    if(map->entries[index].value == BVR_HASHMAP_TOMBSTONE){
+        map->tombstones--;
+    }
+
+    map->entries[index].key = key;
+    map->entries[index].value = value;
+    map->count++;
+
+    return BVR_TRUE;
+}
+
+void* bvr_hashmap_find(bvr_hashmap_t* map, const uint64 key){
+    uint32 iterator = 0;
+    return bvr_hashmap_next(map, key, &iterator);
+}
+
+void* bvr_hashmap_next(bvr_hashmap_t* map, const uint64 key, uint32* iterator){
+    BVR_ASSERT(map);
+    BVR_ASSERT(iterator);
+
+    if(!map->capacity){
+        return NULL;
+    }
+
+    // iterator is the number of already probed entries
+    const uint32 mask = map->capacity - 1;
+    const uint32 start = bvri_hash_key(key) & mask;
+
+    while (*iterator < map->capacity)
+    {
+        struct bvr_hashmap_entry_s* entry = &map->entries[(start + *iterator) & mask];
+        (*iterator)++;
+
+        if(!entry->value){
+            *iterator = map->capacity;
+            return NULL;
+        }
+
+        if(entry->value != BVR_HASHMAP_TOMBSTONE && entry->key == key){
+            return entry->value;
+        }
+    }
+
+    return NULL;
+}
+
+int bvr_hashmap_remove(bvr_hashmap_t* map, const uint64 key, const void* value){
+    BVR_ASSERT(map);
+
+    if(!map->capacity){
+        return BVR_FALSE;
+    }
+
+    const uint32 mask = map->capacity - 1;
+    uint32 index = bvri_hash_key(key) & mask;
+
+    for (uint32 i = 0; i < map->capacity && map->entries[index].value; i++)
+    {
+        struct bvr_hashmap_entry_s* entry = &map->entries[index];
+
+        if(entry->value != BVR_HASHMAP_TOMBSTONE && entry->key == key && 
+            (!value || entry->value == value)){
+            
+            entry->value = BVR_HASHMAP_TOMBSTONE;
+            map->count--;
+            map->tombstones++;
+
+            return BVR_TRUE;
         }
+
+        index = (index + 1) & mask;
     }
 
-    block->next = pool->next_block;
-    block->data = NULL;
+    return BVR_FALSE;
+}
+
+void bvr_hashmap_clear(bvr_hashmap_t* map){
+    BVR_ASSERT(map);
 
-    pool->next_block = block;
-    pool->count--;
+    if(map->entries){
+        memset(map->entries, 0, map->capacity * sizeof(struct bvr_hashmap_entry_s));
+    }
+
+    map->count = 0;
+    map->tombstones = 0;
 }
 
-void bvr_pool_remove(bvr_pool_t* pool, const void* value){
-    BVR_ASSERT(pool);
-    BVR_ASSERT(value);
+void bvr_destroy_hashmap(bvr_hashmap_t* map){
+    BVR_ASSERT(map);
+
+    free(map->entries);
+
+    map->entries = NULL;
+    map->count = 0;
+    map->tombstones = 0;
+    map->capacity = 0;
+}
+
+/*
+    Interned string's header, string's chars directly follow the header.
+*/
+struct bvri_atom_record_s {
+    uint64 hash;
+    uint32 length;
+    bvr_atom_t atom;
+};
+
+static struct {
+    // string records
+    bvr_memstream_t strings;
+
+    // string's hash -> record
+    bvr_hashmap_t table;
+
+    // atom - 1 -> record
+    struct bvri_atom_record_s** records;
+    uint32 count;
+    uint32 capacity;
+} bvri_string_table;
+
+/*
+    FNV-1a hash
+*/
+static uint64 bvri_hash_string(const char* string, const uint64 length){
+    uint64 hash = 0xcbf29ce484222325ULL;
+    for (uint64 i = 0; i < length; i++)
+    {
+        hash ^= (uint8)string[i];
+        hash *= 0x100000001b3ULL;
+    }
+    
+    return hash;
+}
+
+static struct bvri_atom_record_s* bvri_find_atom_record(const char* string, const uint64 length, const uint64 hash){
+    struct bvri_atom_record_s* record;
+    uint32 iterator = 0;
 
-    for (struct bvr_pool_block_u* b = pool->blocks; b->next; b++)
+    while ((record = bvr_hashmap_next(&bvri_string_table.table, hash, &iterator)))
     {
-        if(b->data && value == *(void**)b->data){
-            bvr_pool_free(pool, b);
-            return;
+        if(record->length == length && memcmp(record + 1, string, length) == 0){
+            return record;
         }
     }
+
+    return NULL;
+}
+
+bvr_atom_t bvr_intern(const char* string){
+    if(!string){
+        return BVR_NULL_ATOM;
+    }
+
+    return bvr_intern_n(string, strlen(string));
+}
+
+bvr_atom_t bvr_intern_n(const char* string, const uint64 length){
+    if(!string){
+        return BVR_NULL_ATOM;
+    }
+
+    const uint64 hash = bvri_hash_string(string, length);
+    struct bvri_atom_record_s* record = bvri_find_atom_record(string, length, hash);
+    
+    if(record){
+        return record->atom;
+    }
+
+    // grow atom's lookup array
+    if(bvri_string_table.count == bvri_string_table.capacity){
+        bvri_string_table.capacity = bvri_string_table.capacity ? bvri_string_table.capacity * 2 : 64;
+        bvri_string_table.records = realloc(bvri_string_table.records, 
+            bvri_string_table.capacity * sizeof(struct bvri_atom_record_s*)
+        );
+        BVR_ASSERT(bvri_string_table.records);
+    }
+
+    // records are stored inside the stream, so that their addresses never change
+    record = (struct bvri_atom_record_s*)bvr_memstream_alloc(&bvri_string_table.strings, 
+        sizeof(struct bvri_atom_record_s) + length + 1, __alignof__(struct bvri_atom_record_s)
+    );
+
+    record->hash = hash;
+    record->length = length;
+    record->atom = ++bvri_string_table.count;
+    memcpy(record + 1, string, length);
+    ((char*)(record + 1))[length] = '\0';
+
+    bvri_string_table.records[record->atom - 1] = record;
+    bvr_hashmap_insert(&bvri_string_table.table, hash, record);
+
+    return record->atom;
+}
+
+bvr_atom_t bvr_find_atom(const char* string){
+    if(!string){
+        return BVR_NULL_ATOM;
+    }
+
+    const uint64 length = strlen(string);
+    struct bvri_atom_record_s* record = bvri_find_atom_record(string, length, bvri_hash_string(string, length));
+    
+    if(record){
+        return record->atom;
+    }
+
+    return BVR_NULL_ATOM;
+}
+
+const char* bvr_atom_string(const bvr_atom_t atom){
+    if(atom == BVR_NULL_ATOM || atom > bvri_string_table.count){
+        return NULL;
+    }
+
+    return (const char*)(bvri_string_table.records[atom - 1] + 1);
 }
 
-void bvr_destroy_pool(bvr_pool_t* pool){
-    BVR_ASSERT(pool);
+uint32 bvr_atom_length(const bvr_atom_t atom){
+    if(atom == BVR_NULL_ATOM || atom > bvri_string_table.count){
+        return 0;
+    }
+
+    return bvri_string_table.records[atom - 1]->length;
+}
 
-    free(pool->data);
+void bvr_destroy_string_table(void){
+    bvr_destroy_memstream(&bvri_string_table.strings);
+    bvr_destroy_hashmap(&bvri_string_table.table);
+    free(bvri_string_table.records);
 
-    pool->data = NULL;
-    pool->avail = NULL;
-    pool->blocks = NULL;
-    pool->next_block = NULL;
+    bvri_string_table.records = NULL;
+    bvri_string_table.count = 0;
+    bvri_string_table.capacity = 0;
 }
\ No newline at end of file
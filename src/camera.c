@@ -135,6 +135,8 @@ void bvr_create_camera(bvr_camera_t* camera, const bvr_framebuffer_t* target, in
     BVR_IDENTITY_VEC4(camera->transform.rotation);
     BVR_IDENTITY_VEC3(camera->transform.scale);
     BVR_IDENTITY_MAT4(camera->transform.matrix);
+    BVR_IDENTITY_MAT4(camera->view);
+    BVR_IDENTITY_MAT4(camera->projection);
 
     bvr_create_uniform_buffer(&camera->buffer, 2 * sizeof(mat4x4), BVR_UNIFORM_BLOCK_CAMERA);
 }
@@ -193,6 +195,8 @@ void bvr_update_camera(bvr_camera_t* camera){
     view[1][3] = 0.0f;
     view[3][3] = 1.0f;
 
+    memcpy(camera->view, view, sizeof(mat4x4));
+
     bvr_enable_uniform_buffer(camera->buffer);
     bvr_uniform_buffer_set(sizeof(mat4x4), sizeof(mat4x4), &view[0][0]);
 
@@ -207,7 +211,53 @@ void bvr_update_camera(bvr_camera_t* camera){
     bvr_enable_uniform_buffer(0);
 }
 
+void bvr_camera_view_bounds(bvr_camera_t* camera, struct bvr_aabb_s* bounds){
+    BVR_ASSERT(camera);
+    BVR_ASSERT(bounds);
+
+    mat4x4 view_projection, inv;
+    mat4_mul(view_projection, camera->projection, camera->view);
+    mat4_inv(inv, view_projection);
+
+    BVR_SCALE_VEC3(bounds->min, INFINITY);
+    BVR_SCALE_VEC3(bounds->max, -INFINITY);
+
+    // unproject clip space's corners
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = {
+            (i & 1) ? 1.0f : -1.0f,
+            (i & 2) ? 1.0f : -1.0f,
+            (i & 4) ? 1.0f : -1.0f
+        };
+
+        mat4_mul_point(corner, inv, corner);
+        bvr_aabb_extend(bounds, corner);
+    }
+}
+
+void bvr_camera_frustum(bvr_camera_t* camera, struct bvr_frustum_s* frustum){
+    BVR_ASSERT(camera);
+    BVR_ASSERT(frustum);
+
+    mat4x4 m;
+    mat4_mul(m, camera->projection, camera->view);
+
+    // https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
+    for (int i = 0; i < 4; i++)
+    {
+        frustum->planes[0][i] = m[i][3] + m[i][0];
+        frustum->planes[1][i] = m[i][3] - m[i][0];
+        frustum->planes[2][i] = m[i][3] + m[i][1];
+        frustum->planes[3][i] = m[i][3] - m[i][1];
+        frustum->planes[4][i] = m[i][3] + m[i][2];
+        frustum->planes[5][i] = m[i][3] - m[i][2];
+    }
+}
+
 static void bvri_update_view(bvr_camera_t* camera, mat4x4 matrix) {
+    memcpy(camera->view, matrix, sizeof(mat4x4));
+
     bvr_enable_uniform_buffer(camera->buffer);
     bvr_uniform_buffer_set(sizeof(mat4x4), sizeof(mat4x4), &matrix[0][0]);
     bvr_enable_uniform_buffer(0);
@@ -239,6 +289,7 @@ static void bvri_update_orthocamera(bvr_camera_t* camera){
     projection[3][2] = -camera->near * farnear;
     projection[3][3] =  1.0f;
 
+    memcpy(camera->projection, projection, sizeof(mat4x4));
     bvr_uniform_buffer_set(0, sizeof(mat4x4), &projection[0][0]);
 }
 
@@ -246,5 +297,6 @@ static void bvri_update_perspcamera(bvr_camera_t* camera){
     mat4x4 projection;
     BVR_IDENTITY_MAT4(projection);
 
+    memcpy(camera->projection, projection, sizeof(mat4x4));
     bvr_uniform_buffer_set(0, sizeof(mat4x4), &projection[0][0]);
 }
\ No newline at end of file
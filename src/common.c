@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 
 #ifdef _WIN32
@@ -211,27 +212,106 @@ unsigned char* bvr_base64_decode(const char* string, size_t length, size_t* deco
 	return out;
 }
 
-void bvr_create_uuid(bvr_uuid_t uuid){
-    const char hex_digits[] = "0123456789abcdefABCDEF";
+static uint64 bvri_splitmix64(uint64* state){
+    uint64 z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64 bvri_rotl(const uint64 x, int k){
+    return (x << k) | (x >> (64 - k));
+}
 
-    for (uint64 i = 0; i < 36; i++)
+void bvr_create_random(bvr_random_t* random, uint64 seed){
+    BVR_ASSERT(random);
+
+    // xoshiro's state must not be all zero, splitmix never returns four zeros
+    for (uint64 i = 0; i < 4; i++)
     {
-        (uuid)[i] = hex_digits[rand() % 22];
+        random->state[i] = bvri_splitmix64(&seed);
     }
-    
-    uuid[8] = '-';
-    uuid[13] = '-';
-    uuid[18] = '-';
-    uuid[23] = '-';
-    uuid[36] = '\0';
+}
+
+uint64 bvr_random_next(bvr_random_t* random){
+    uint64* s = random->state;
+    const uint64 result = bvri_rotl(s[1] * 5, 7) * 9;
+    const uint64 t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = bvri_rotl(s[3], 45);
+
+    return result;
+}
+
+void bvr_create_uuid(bvr_uuid_t uuid){
+    static __thread bvr_random_t random;
+    static __thread bool seeded = false;
+
+    if(!seeded){
+        // mix time and generator's address, so that each thread gets a different sequence
+        bvr_create_random(&random, (uint64)time(NULL) ^ ((uint64)clock() << 32) ^ (uint64)(uintptr_t)&random);
+        seeded = true;
+    }
+
+    uuid[0] = bvr_random_next(&random);
+    uuid[1] = bvr_random_next(&random);
+
+    // version 4 and variant 1 bits
+    uuid[0] = (uuid[0] & ~0xf000ULL) | 0x4000ULL;
+    uuid[1] = (uuid[1] & ~(0x3ULL << 62)) | (0x2ULL << 62);
 }
 
 void bvr_copy_uuid(bvr_uuid_t src, bvr_uuid_t dest){
     memcpy(dest, src, sizeof(bvr_uuid_t));
 }
 
-int bvr_uuid_equals(bvr_uuid_t const a, bvr_uuid_t const b){
-    return strncmp(a, b, sizeof(bvr_uuid_t)) == 0;
+char* bvr_uuid_to_string(bvr_uuid_t const uuid, char* string){
+    BVR_ASSERT(string);
+
+    sprintf(string, "%08x-%04x-%04x-%04x-%012llx", 
+        (uint32)(uuid[0] >> 32), (uint32)(uuid[0] >> 16) & 0xffff, (uint32)uuid[0] & 0xffff,
+        (uint32)(uuid[1] >> 48), uuid[1] & 0xffffffffffffULL
+    );
+
+    return string;
+}
+
+int bvr_uuid_from_string(bvr_uuid_t uuid, const char* string){
+    BVR_ASSERT(string);
+
+    uint64 words[2] = {0, 0};
+    uint64 digits = 0;
+
+    for (uint64 i = 0; i < BVR_UUID_STRING_LENGTH - 1; i++)
+    {
+        const char c = string[i];
+        uint64 value;
+
+        if(i == 8 || i == 13 || i == 18 || i == 23){
+            if(c != '-'){
+                return BVR_FALSE;
+            }
+
+            continue;
+        }
+
+        if(c >= '0' && c <= '9') value = c - '0';
+        else if(c >= 'a' && c <= 'f') value = c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F') value = c - 'A' + 10;
+        else return BVR_FALSE;
+
+        words[digits / 16] = (words[digits / 16] << 4) | value;
+        digits++;
+    }
+
+    uuid[0] = words[0];
+    uuid[1] = words[1];
+    return BVR_TRUE;
 }
 
 #ifdef BVR_INCLUDE_DEBUG
@@ -35,6 +35,9 @@ static void bvri_destroy_editor_render_buffers(uint32* array_buffer, uint32* ver
 
 static bvr_editor_t* __editor = NULL;
 
+// uuid textual form, uuids are converted only when displayed
+static char bvri_uuid_buffer[BVR_UUID_STRING_LENGTH];
+
 static void bvri_draw_editor_vec3(const char* text, vec3 value){
     nk_layout_row_dynamic(__editor->gui.context, 15, 4);
     nk_label_wrap(__editor->gui.context, text);
@@ -90,7 +93,7 @@ static void bvri_draw_editor_mesh(bvr_mesh_t* mesh){
     
     bvr_vertex_group_t* group;
     for(int i = 0; i < mesh->vertex_groups.count; i++){
-        group = bvr_pool_try_get(&mesh->vertex_groups, i);
+        group = bvr_slotmap_at(&mesh->vertex_groups, i);
 
         nk_label_wrap(__editor->gui.context, 
             BVR_FORMAT("%s: %i-%i", group->name.string, group->element_offset, group->element_offset + group->element_count)
@@ -124,7 +127,7 @@ static void bvri_draw_editor_image(bvr_image_t* image){
     nk_layout_row_dynamic(__editor->gui.context, 15, 1);
 
     nk_label(__editor->gui.context, "Image", NK_TEXT_ALIGN_CENTERED);
-    nk_label_wrap(__editor->gui.context, image->asset.pointer.asset_id);
+    nk_label_wrap(__editor->gui.context, bvr_uuid_to_string(image->asset.pointer.asset_id, bvri_uuid_buffer));
 
     char format[16];
     bvr_nameof(image->format, format);
@@ -185,7 +188,7 @@ static void bvri_draw_editor_shader(bvr_shader_t* shader){
     nk_label(__editor->gui.context, "Shader", NK_TEXT_ALIGN_CENTERED);    
 
     if(shader->asset.origin != BVR_ASSET_ORIGIN_NONE){
-        nk_label(__editor->gui.context, shader->asset.pointer.asset_id, NK_TEXT_ALIGN_LEFT);
+        nk_label(__editor->gui.context, bvr_uuid_to_string(shader->asset.pointer.asset_id, bvri_uuid_buffer), NK_TEXT_ALIGN_LEFT);
     }
     
     if(shader->uniform_count){
@@ -198,7 +201,7 @@ static void bvri_draw_editor_shader(bvr_shader_t* shader){
             {
                 bvr_nameof(shader->uniforms[i].type, type_name);
 
-                nk_label_wrap(__editor->gui.context, BVR_FORMAT("%s", shader->uniforms[i].name.string));  
+                nk_label_wrap(__editor->gui.context, BVR_FORMAT("%s", bvr_atom_string(shader->uniforms[i].name)));  
 
                 nk_label_wrap(__editor->gui.context, BVR_FORMAT("%s", type_name));     
             }
@@ -244,6 +247,41 @@ static void bvri_draw_hierarchy_button(const char* name, uint64 type, void* obje
     }
 }
 
+static void bvri_draw_actor_button(struct bvr_actor_s* actor){
+    switch (actor->type)
+    {
+    case BVR_LANDSCAPE_ACTOR:
+        bvri_draw_hierarchy_button(bvr_atom_string(actor->name), BVR_EDITOR_LANDSCAPE, actor);
+        break;
+    
+    default:
+        bvri_draw_hierarchy_button(bvr_atom_string(actor->name), BVR_EDITOR_ACTOR, actor);
+        break;
+    }
+}
+
+/*
+    Draw actor's button, and a collapsible node holding its children.
+*/
+static void bvri_draw_actor_tree(struct bvr_actor_s* actor){
+    bvri_draw_actor_button(actor);
+
+    if(!actor->first_child){
+        return;
+    }
+
+    // actor's uuid is used as node's id
+    if(nk_tree_push_hashed(__editor->gui.context, NK_TREE_NODE, "children", NK_MAXIMIZED, 
+        (const char*)actor->id, sizeof(bvr_uuid_t), __LINE__)){
+        
+        for (struct bvr_actor_s* child = actor->first_child; child; child = child->next_sibling){
+            bvri_draw_actor_tree(child);
+        }
+
+        nk_tree_pop(__editor->gui.context);
+    }
+}
+
 static void bvri_load_landscape(bvr_string_t* path){
     BVR_PRINTF("load map %s", path->string);
 
@@ -398,19 +436,19 @@ void bvr_editor_draw_page_hierarchy(){
                     }
 
                     if(nk_menu_item_label(__editor->gui.context, "save garbage", NK_TEXT_ALIGN_LEFT)){
-                        if(__editor->book->garbage_stream.data){
+                        if(__editor->book->garbage_stream.pages){
                             remove("garbagedump.bin");
                             FILE* file = fopen("garbagedump.bin", "wb");
-                            fwrite(__editor->book->garbage_stream.data, sizeof(char), __editor->book->garbage_stream.size, file);
+                            bvr_memstream_fwrite(&__editor->book->garbage_stream, file);
                             fclose(file);
                         }
                     }
 
                     if(nk_menu_item_label(__editor->gui.context, "save assets", NK_TEXT_ALIGN_LEFT)){
-                        if(__editor->book->asset_stream.data){
+                        if(__editor->book->asset_stream.pages){
                             remove("assetsdump.bin");
                             FILE* file = fopen("assetsdump.bin", "wb");
-                            fwrite(__editor->book->asset_stream.data, sizeof(char), __editor->book->asset_stream.size, file);
+                            bvr_memstream_fwrite(&__editor->book->asset_stream, file);
                             fclose(file);
                         }
                     }
@@ -447,7 +485,7 @@ void bvr_editor_draw_page_hierarchy(){
         {
             nk_layout_row_dynamic(__editor->gui.context, 15, 1);
 
-            if(__editor->book->asset_stream.data){
+            if(__editor->book->asset_stream.pages){
                 bvri_draw_hierarchy_button("assets", BVR_EDITOR_ASSETS, &__editor->book->asset_stream);
             }
 
@@ -459,11 +497,7 @@ void bvr_editor_draw_page_hierarchy(){
             }
             
             struct bvr_light_s* light = NULL;
-            BVR_POOL_FOR_EACH(light, __editor->book->page.lights){
-                if(!light) {
-                    break;
-                }
-
+            BVR_SLOTMAP_FOR_EACH(light, __editor->book->page.lights){
                 switch (light->type)
                 {
                 case BVR_LIGHT_NONE: break;
@@ -485,21 +519,11 @@ void bvr_editor_draw_page_hierarchy(){
         {
             nk_layout_row_dynamic(__editor->gui.context, 15, 1);
             
+            // children are drawn by their parent's node
             struct bvr_actor_s* actor = NULL;
-            BVR_POOL_FOR_EACH(actor, __editor->book->page.actors){
-                if(!actor){
-                    break;
-                }
-
-                switch (actor->type)
-                {
-                case BVR_LANDSCAPE_ACTOR:
-                    bvri_draw_hierarchy_button(actor->name.string, BVR_EDITOR_LANDSCAPE, actor);
-                    break;
-                
-                default:
-                    bvri_draw_hierarchy_button(actor->name.string, BVR_EDITOR_ACTOR, actor);
-                    break;
+            BVR_SLOTMAP_FOR_EACH(actor, __editor->book->page.actors){
+                if(!actor->parent){
+                    bvri_draw_actor_tree(actor);
                 }
             }
 
@@ -512,11 +536,7 @@ void bvr_editor_draw_page_hierarchy(){
             nk_layout_row_dynamic(__editor->gui.context, 15, 1);
             
             struct bvr_collider_s* collider = NULL;
-            BVR_POOL_FOR_EACH(collider, __editor->book->page.colliders){
-                if(!collider){
-                    break;
-                }
-
+            BVR_SLOTMAP_FOR_EACH(collider, __editor->book->page.colliders){
                 /*bvri_draw_hierarchy_button(
                     BVR_FORMAT("collider%x", (uint64)blockcollider - (uint64)__editor->book->page.colliders.data),
                     BVR_EDITOR_COLLIDER, collider
@@ -607,6 +627,34 @@ void bvr_editor_draw_inspector(){
 
                 nk_label(__editor->gui.context, BVR_FORMAT("render time %f ms", __editor->book->timer.delta_timef), NK_TEXT_ALIGN_LEFT);
                 nk_label(__editor->gui.context, BVR_FORMAT("fps %i", __editor->book->timer.average_render_time), NK_TEXT_ALIGN_LEFT);
+                nk_label(__editor->gui.context, BVR_FORMAT("ticks %u (%.0f Hz)", __editor->book->timer.ticks, 1.0f / __editor->book->timer.fixed_delta_timef), NK_TEXT_ALIGN_LEFT);
+                nk_label(__editor->gui.context, BVR_FORMAT("frame memory %llu/%llu bytes (peak %llu)", 
+                    bvr_frame_arena_previous(&__editor->book->frame_memory)->used,
+                    bvr_frame_arena_previous(&__editor->book->frame_memory)->size,
+                    bvr_frame_arena_previous(&__editor->book->frame_memory)->peak), NK_TEXT_ALIGN_LEFT
+                );
+                nk_label(__editor->gui.context, BVR_FORMAT("draw commands %u/%u (peak %u)", 
+                    pipeline->command_count, pipeline->command_capacity, pipeline->command_peak), NK_TEXT_ALIGN_LEFT
+                );
+                nk_label(__editor->gui.context, BVR_FORMAT("page draw: %u visible, %u culled, %u commands", 
+                    pipeline->stats.visible, pipeline->stats.culled, pipeline->stats.submitted), NK_TEXT_ALIGN_LEFT
+                );
+                nk_label(__editor->gui.context, BVR_FORMAT("redundant gl calls avoided %u", pipeline->stats.avoided), NK_TEXT_ALIGN_LEFT);
+                nk_label(__editor->gui.context, BVR_FORMAT("instanced: %u draws for %u commands", 
+                    pipeline->stats.instanced_draws, pipeline->stats.instanced_commands), NK_TEXT_ALIGN_LEFT
+                );
+                nk_label(__editor->gui.context, BVR_FORMAT("object buffer: %u objects", pipeline->stats.objects), NK_TEXT_ALIGN_LEFT);
+                nk_label(__editor->gui.context, BVR_FORMAT("sprites: %u in %u batches, %llu bytes streamed", 
+                    pipeline->stats.sprites, pipeline->stats.sprite_batches, pipeline->stats.streamed_bytes), NK_TEXT_ALIGN_LEFT
+                );
+                nk_label(__editor->gui.context, BVR_FORMAT("actors %u/%u (peak %u)", 
+                    __editor->book->page.actors.count, __editor->book->page.actors.capacity, 
+                    __editor->book->page.actors.peak), NK_TEXT_ALIGN_LEFT
+                );
+                nk_label(__editor->gui.context, BVR_FORMAT("colliders %u/%u (peak %u)", 
+                    __editor->book->page.colliders.count, __editor->book->page.colliders.capacity, 
+                    __editor->book->page.colliders.peak), NK_TEXT_ALIGN_LEFT
+                );
 
                 nk_checkbox_label(__editor->gui.context, "is blending", (int*)&pipeline->rendering_pass.blending);
                 nk_checkbox_label(__editor->gui.context, "is depth testing", (int*)&pipeline->rendering_pass.depth);
@@ -705,20 +753,25 @@ void bvr_editor_draw_inspector(){
                 while (!bvr_memstream_eof(stream))
                 {
                     bvr_memstream_read(stream, &asset.id, sizeof(bvr_uuid_t));
-                    if(asset.id[0] + asset.id[1] + asset.id[2] == 0){
+                    if(bvr_uuid_is_null(asset.id)){
                         break;
                     }
 
                     bvr_memstream_read(stream, &asset.path.length, sizeof(uint16));
 
-                    asset.path.string = stream->cursor;
+                    // records are contiguous
+                    asset.path.string = bvr_memstream_peek(stream, asset.path.length);
+                    if(!asset.path.string){
+                        break;
+                    }
+
                     bvr_memstream_seek(stream, asset.path.length, SEEK_CUR);
                     bvr_memstream_read(stream, &asset.open_mode, sizeof(uint8));
 
                     nk_layout_row_dynamic(__editor->gui.context, 45, 1);
                     if(nk_group_begin(__editor->gui.context, BVR_MACRO_STR(__LINE__), NK_WINDOW_BORDER | NK_WINDOW_NO_SCROLLBAR)){
                         nk_layout_row_dynamic(__editor->gui.context, 15, 1);
-                        nk_label(__editor->gui.context, asset.id, NK_TEXT_ALIGN_LEFT);
+                        nk_label(__editor->gui.context, bvr_uuid_to_string(asset.id, bvri_uuid_buffer), NK_TEXT_ALIGN_LEFT);
 
                         nk_layout_row_dynamic(__editor->gui.context, 15, 2);
                         nk_label(__editor->gui.context, asset.path.string, NK_TEXT_ALIGN_CENTERED);
@@ -740,7 +793,7 @@ void bvr_editor_draw_inspector(){
                 }
 
                 if(nk_button_label(__editor->gui.context, "Clear")){
-                    bvr_memstream_clear(&__editor->book->asset_stream);
+                    bvr_clear_assets();
                 }
             }
             break;
@@ -750,13 +803,14 @@ void bvr_editor_draw_inspector(){
                 struct bvr_actor_s* actor = (struct bvr_actor_s*)__editor->inspector_cmd.pointer;
                 
                 nk_layout_row_dynamic(__editor->gui.context, 15, 1);
-                nk_label(__editor->gui.context, BVR_FORMAT("id %s", actor->id), NK_TEXT_ALIGN_LEFT);
+                nk_label(__editor->gui.context, BVR_FORMAT("id %s", bvr_uuid_to_string(actor->id, bvri_uuid_buffer)), NK_TEXT_ALIGN_LEFT);
                 nk_label(__editor->gui.context, BVR_FORMAT("flags %x", actor->flags), NK_TEXT_ALIGN_LEFT);
 
                 nk_checkbox_label(__editor->gui.context, "is active", (nk_bool*)&actor->active);
                 nk_property_short(__editor->gui.context, "order in layer", 0, &actor->order_in_layer, SHRT_MAX, 1, 1.0f);
 
                 bvri_draw_editor_transform(&actor->transform);
+                bvr_set_actor_dirty(actor);
 
                 nk_layout_row_dynamic(__editor->gui.context, 15, 1);
                 switch (actor->type)
@@ -901,12 +955,13 @@ void bvr_editor_draw_inspector(){
                 bvr_landscape_actor_t* landscape = (bvr_landscape_actor_t*)__editor->inspector_cmd.pointer;
                 
                 nk_layout_row_dynamic(__editor->gui.context, 15, 1);
-                nk_label(__editor->gui.context, BVR_FORMAT("id %s", landscape->self.id), NK_TEXT_ALIGN_LEFT);
+                nk_label(__editor->gui.context, BVR_FORMAT("id %s", bvr_uuid_to_string(landscape->self.id, bvri_uuid_buffer)), NK_TEXT_ALIGN_LEFT);
                 nk_label(__editor->gui.context, BVR_FORMAT("flags %x", landscape->self.flags), NK_TEXT_ALIGN_LEFT);
 
                 nk_checkbox_label(__editor->gui.context, "is active", (nk_bool*)&landscape->self.active);
 
                 bvri_draw_editor_transform(&landscape->self.transform);
+                bvr_set_actor_dirty(&landscape->self);
 
                     nk_layout_row_dynamic(__editor->gui.context, 15, 1);
                 nk_label(__editor->gui.context, "LANDSCAPE", NK_TEXT_ALIGN_CENTERED);
@@ -1072,8 +1127,8 @@ int bvri_create_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffe
     glGenVertexArrays(1, array_buffer);
     glGenBuffers(1, vertex_buffer);
 
-    glBindVertexArray(*array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, *vertex_buffer);
+    bvr_gl_bind_vertex_array(*array_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, *vertex_buffer);
 
     glBufferData(GL_ARRAY_BUFFER, vertex_size * sizeof(float), NULL, GL_DYNAMIC_DRAW);
 
@@ -1081,15 +1136,15 @@ int bvri_create_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffe
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
     glDisableVertexAttribArray(0);
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bvr_gl_bind_vertex_array(0);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
 
     return BVR_TRUE;
 }
 
 void bvri_bind_editor_buffers(uint32 array_buffer, uint32 vertex_buffer){
-    glBindVertexArray(array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    bvr_gl_bind_vertex_array(array_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, vertex_buffer);
 }
 
 void bvri_set_editor_buffers(float* vertices, uint32 vertices_count, uint8 stride){
@@ -1108,6 +1163,9 @@ void bvri_draw_editor_buffer(int drawmode, uint32 element_offset, uint32 element
 }
 
 void bvri_destroy_editor_render_buffers(uint32* array_buffer, uint32* vertex_buffer){
+    bvr_gl_state_forget(*array_buffer);
+    bvr_gl_state_forget(*vertex_buffer);
+
     glDeleteVertexArrays(1, array_buffer);
     glDeleteBuffers(1, vertex_buffer);
 }
\ No newline at end of file
@@ -48,7 +48,7 @@ struct bvr_tile_s bvri_landscape_get_tile(bvr_landscape_actor_t *actor, int id)
         return tile;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
 
     vertices = glMapBufferRange(GL_ARRAY_BUFFER, 0, actor->mesh.vertex_count * sizeof(int), GL_MAP_READ_BIT);
     if (vertices)
@@ -57,7 +57,7 @@ struct bvr_tile_s bvri_landscape_get_tile(bvr_landscape_actor_t *actor, int id)
         glUnmapBuffer(GL_ARRAY_BUFFER);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
 
     return tile;
 }
@@ -108,7 +108,7 @@ static int bvri_landscapejson(FILE* file, bvr_landscape_actor_t* actor){
         return BVR_FALSE;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
 
     // check if memory is correctly unmapped
     tiles = (struct bvr_tile_s*)glMapBufferRange(GL_ARRAY_BUFFER, 0, 
@@ -188,7 +188,7 @@ static int bvri_landscapejson(FILE* file, bvr_landscape_actor_t* actor){
     }
 
     glUnmapBuffer(GL_ARRAY_BUFFER);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
 
     return BVR_TRUE;
 }
@@ -230,7 +230,7 @@ int bvr_landscape_loadf(FILE* file, bvr_landscape_actor_t* actor){
 /*if(0){
     nk_label(__editor->gui.context, "TILE INFORMATIONS", NK_TEXT_ALIGN_LEFT);
 
-    glBindBuffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, actor->mesh.vertex_buffer);
     int* vertices_map = glMapBufferRange(GL_ARRAY_BUFFER, 0, actor->mesh.vertex_count * sizeof(int), GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
     if(vertices_map){
         // extract each values through bitwise operations
@@ -268,6 +268,6 @@ int bvr_landscape_loadf(FILE* file, bvr_landscape_actor_t* actor){
             vertices_map[next_row_vertex] = (vertices_map[next_row_vertex] & ~0xff) | altitude[1];
         }
         glUnmapBuffer(GL_ARRAY_BUFFER);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
     }
 }*/
\ No newline at end of file
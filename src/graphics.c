@@ -8,6 +8,7 @@
 
 #include <memory.h>
 #include <malloc.h>
+#include <stddef.h>
 
 static void bvri_pipeline_restore_blending(struct bvr_pipeline_state_s* const state);
 static void bvri_pipeline_restore_depth(struct bvr_pipeline_state_s* const state);
@@ -17,8 +18,98 @@ void bvr_pipeline_state_enable(struct bvr_pipeline_state_s* const state){
     bvri_pipeline_restore_depth(state);
 }
 
-void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd){
-    // try to apply local uniform
+/*
+    Returns BVR_TRUE if `cmd` is drawn through the instance buffer
+*/
+static int bvri_is_instanced(const struct bvr_draw_command_s* cmd){
+    return cmd->instance && cmd->shader && BVR_HAS_FLAG(cmd->shader->flags, BVR_SHADER_EXT_INSTANCING);
+}
+
+/*
+    Returns BVR_TRUE if `b` can be drawn inside `a`'s instanced draw.
+    Both shaders must point to the same uniform values (the transform is replaced by instances),
+    this is true for shaders copied from each other. Vertex groups must share their local matrix.
+*/
+static int bvri_can_instance(const struct bvr_draw_command_s* a, const struct bvr_draw_command_s* b){
+    if(!bvri_is_instanced(b) ||
+        a->shader->program != b->shader->program ||
+        a->array_buffer != b->array_buffer ||
+        a->element_buffer != b->element_buffer ||
+        a->draw_mode != b->draw_mode ||
+        a->element_type != b->element_type ||
+        a->vertex_group.element_offset != b->vertex_group.element_offset ||
+        a->vertex_group.element_count != b->vertex_group.element_count ||
+        a->vertex_group.texture != b->vertex_group.texture){
+        
+        return BVR_FALSE;
+    }
+
+    // the local transform is a uniform, it is shared by the whole run
+    if(memcmp(a->vertex_group.matrix, b->vertex_group.matrix, sizeof(mat4x4)) != 0){
+        return BVR_FALSE;
+    }
+
+    if(a->shader == b->shader){
+        return BVR_TRUE;
+    }
+
+    if(a->shader->uniform_count != b->shader->uniform_count){
+        return BVR_FALSE;
+    }
+
+    for (uint32 i = 1; i < a->shader->uniform_count; i++)
+    {
+        if(a->shader->uniforms[i].memory.data != b->shader->uniforms[i].memory.data){
+            return BVR_FALSE;
+        }
+    }
+
+    return BVR_TRUE;
+}
+
+/*
+    Point per-instance attributes of the bound vertex array at `offset` inside the instance buffer
+*/
+static void bvri_set_instance_attributes(const uint64 offset){
+    const uint32 location = BVR_INSTANCE_ATTRIB_LOCATION;
+    const int stride = sizeof(struct bvr_instance_s);
+
+    // a matrix takes a location per column
+    for (uint32 i = 0; i < 4; i++)
+    {
+        glEnableVertexAttribArray(location + i);
+        glVertexAttribPointer(location + i, 4, GL_FLOAT, GL_FALSE, stride, 
+            (void*)(offset + offsetof(struct bvr_instance_s, matrix) + i * sizeof(vec4)));
+        glVertexAttribDivisor(location + i, 1);
+    }
+
+    glEnableVertexAttribArray(location + 4);
+    glVertexAttribPointer(location + 4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(struct bvr_instance_s, tint)));
+    glVertexAttribDivisor(location + 4, 1);
+
+    glEnableVertexAttribArray(location + 5);
+    glVertexAttribPointer(location + 5, 1, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(struct bvr_instance_s, layer)));
+    glVertexAttribDivisor(location + 5, 1);
+}
+
+/*
+    Draw `count` commands with the first command's mesh and shader, 
+    commands are `commands[order[i]]` or `commands[i]` if order is NULL.
+*/
+static void bvri_draw_instances(bvr_pipeline_t* pipeline, struct bvr_draw_command_s* commands, 
+    const uint32* order, const uint32 count){
+    
+    struct bvr_draw_command_s* cmd = &commands[order ? order[0] : 0];
+
+    if(!pipeline->instances.buffer){
+        glGenBuffers(1, &pipeline->instances.buffer);
+        bvr_gl_bind_buffer(GL_ARRAY_BUFFER, pipeline->instances.buffer);
+        glBufferData(GL_ARRAY_BUFFER, BVR_INSTANCE_BUFFER_SIZE * sizeof(struct bvr_instance_s), NULL, GL_STREAM_DRAW);
+
+        pipeline->instances.count = 0;
+    }
+
+    // try to apply local uniform, runs only merge commands sharing the group's matrix
     bvr_shader_set_uniformi(
         bvr_find_uniform_tag(cmd->shader, BVR_UNIFORM_LOCAL_TRANSFORM), 
         cmd->vertex_group.matrix
@@ -26,14 +117,111 @@ void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd){
 
     bvr_shader_enable(cmd->shader);
 
-    glBindVertexArray(cmd->array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, cmd->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_buffer);
+    bvr_gl_bind_vertex_array(cmd->array_buffer);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, pipeline->instances.buffer);
 
-    for (uint64 i = 0; i < cmd->attrib_count; i++)
+    uint32 drawn = 0;
+    while (drawn < count)
     {
-        glEnableVertexAttribArray(i);
+        // orphan the buffer once full, pending draws keep the previous storage
+        if(pipeline->instances.count == BVR_INSTANCE_BUFFER_SIZE){
+            glBufferData(GL_ARRAY_BUFFER, BVR_INSTANCE_BUFFER_SIZE * sizeof(struct bvr_instance_s), NULL, GL_STREAM_DRAW);
+            pipeline->instances.count = 0;
+        }
+
+        const uint32 batch = MIN(count - drawn, BVR_INSTANCE_BUFFER_SIZE - pipeline->instances.count);
+        const uint64 offset = pipeline->instances.count * sizeof(struct bvr_instance_s);
+
+        // instances are only appended, previous draws never read the mapped range
+        struct bvr_instance_s* instances = glMapBufferRange(GL_ARRAY_BUFFER, offset, batch * sizeof(struct bvr_instance_s),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+        );
+
+        if(!instances){
+            BVR_PRINT("failed to map instance buffer!");
+            return;
+        }
+
+        for (uint32 i = 0; i < batch; i++)
+        {
+            const uint32 index = order ? order[drawn + i] : drawn + i;
+            memcpy(&instances[i], commands[index].instance, sizeof(struct bvr_instance_s));
+        }
+
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+
+        bvri_set_instance_attributes(offset);
+
+        if(cmd->element_buffer){
+            glDrawElementsInstanced(cmd->draw_mode, cmd->vertex_group.element_count, cmd->element_type, NULL, batch);
+        }
+        else {
+            glDrawArraysInstanced(cmd->draw_mode, cmd->vertex_group.element_offset, cmd->vertex_group.element_count, batch);
+        }
+
+        pipeline->instances.count += batch;
+        pipeline->stats.instanced_draws++;
+        drawn += batch;
+    }
+
+    pipeline->stats.instanced_commands += count;
+
+    // update pipeline state
+    pipeline->state.command = cmd;
+}
+
+/*
+    Returns BVR_TRUE if `cmd` reads its instance from the object buffer
+*/
+static int bvri_uses_object_buffer(const struct bvr_draw_command_s* cmd){
+    return cmd->instance && cmd->shader && !bvri_is_instanced(cmd) && 
+        BVR_HAS_FLAG(cmd->shader->flags, BVR_SHADER_EXT_OBJECT_BUFFER);
+}
+
+/*
+    Bind command's object range to BVR_UNIFORM_BLOCK_OBJECT
+*/
+static void bvri_bind_object(bvr_pipeline_t* pipeline, const struct bvr_draw_command_s* cmd){
+    if(!pipeline->objects.buffer || cmd->object_offset == BVR_INVALID_INDEX){
+        return;
     }
+
+    // binding a range also changes the generic binding, keep the cache in sync
+    bvr_gl_bind_buffer(GL_UNIFORM_BUFFER, pipeline->objects.buffer);
+
+    if(pipeline->objects.bound == cmd->object_offset){
+        return;
+    }
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, BVR_UNIFORM_BLOCK_OBJECT, pipeline->objects.buffer, 
+        cmd->object_offset, sizeof(struct bvr_instance_s));
+    
+    pipeline->objects.bound = cmd->object_offset;
+}
+
+void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd){
+    // instanced draws apply the local uniform themselves
+    if(bvri_is_instanced(cmd)){
+        bvri_draw_instances(&bvr_get_instance()->pipeline, cmd, NULL, 1);
+        return;
+    }
+
+    // try to apply local uniform
+    bvr_shader_set_uniformi(
+        bvr_find_uniform_tag(cmd->shader, BVR_UNIFORM_LOCAL_TRANSFORM), 
+        cmd->vertex_group.matrix
+    );
+
+    bvr_shader_enable(cmd->shader);
+
+    if(bvri_uses_object_buffer(cmd)){
+        bvri_bind_object(&bvr_get_instance()->pipeline, cmd);
+    }
+
+    // attributes are enabled by the vertex array, the state stays bound for the next command
+    bvr_gl_bind_vertex_array(cmd->array_buffer);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_buffer);
     
     // if use element 
     if(cmd->element_buffer){ 
@@ -49,19 +237,64 @@ void bvr_pipeline_draw_cmd(struct bvr_draw_command_s* cmd){
         glDrawArrays(cmd->draw_mode, cmd->vertex_group.element_offset, cmd->vertex_group.element_count);
     }
 
-    for (uint64 i = 0; i < cmd->attrib_count; i++)
+    // update pipeline state
+    bvr_get_instance()->pipeline.state.command = cmd;
+}
+
+uint32 bvr_pipeline_draw_run(bvr_pipeline_t* pipeline, const uint32* order, const uint32 count){
+    BVR_ASSERT(pipeline);
+    BVR_ASSERT(order);
+
+    if(!count){
+        return 0;
+    }
+
+    struct bvr_draw_command_s* first = &pipeline->commands[order[0]];
+    if(!bvri_is_instanced(first)){
+        bvr_pipeline_draw_cmd(first);
+        return 1;
+    }
+
+    // sorting keeps commands sharing mesh, shader and texture together
+    uint32 run = 1;
+    while (run < count && bvri_can_instance(first, &pipeline->commands[order[run]]))
     {
-        glDisableVertexAttribArray(i);
+        run++;
     }
 
-    glBindVertexArray(cmd->array_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, cmd->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cmd->element_buffer);
+    bvri_draw_instances(pipeline, pipeline->commands, order, run);
+    return run;
+}
 
-    bvr_shader_disable();
+/*
+    Grow a command array so it can hold `required` commands.
+*/
+static int bvri_reserve_commands(struct bvr_draw_command_s** commands, uint32* capacity, const uint32 required){
+    if(required <= *capacity){
+        return BVR_TRUE;
+    }
 
-    // update pipeline state
-    bvr_get_instance()->pipeline.state.command = cmd;
+#ifdef BVR_NO_GROWTH
+    // fixed-size lists drop the draw
+    BVR_PRINT("draw command list is full!");
+    return BVR_FALSE;
+#else
+    uint32 new_capacity = MAX(*capacity * 2, BVR_MAX_DRAW_COMMAND);
+    while (new_capacity < required)
+    {
+        new_capacity *= 2;
+    }
+
+    struct bvr_draw_command_s* grown = realloc(*commands, new_capacity * sizeof(struct bvr_draw_command_s));
+    if(!grown){
+        BVR_PRINT("failed to grow draw command list!");
+        return BVR_FALSE;
+    }
+
+    *commands = grown;
+    *capacity = new_capacity;
+    return BVR_TRUE;
+#endif
 }
 
 void bvr_pipeline_add_draw_cmd(struct bvr_draw_command_s* cmd){
@@ -72,10 +305,183 @@ void bvr_pipeline_add_draw_cmd(struct bvr_draw_command_s* cmd){
     //     BVR_PRINT("invalid shader!");
     // }
 
-    if(bvr_get_instance()->pipeline.command_count + 1 < BVR_MAX_DRAW_COMMAND){
-        memcpy(&bvr_get_instance()->pipeline.commands[bvr_get_instance()->pipeline.command_count++], 
-            cmd, sizeof(struct bvr_draw_command_s)
-        );
+    bvr_pipeline_t* pipeline = &bvr_get_instance()->pipeline;
+
+    // workers never touch the shared list
+    struct bvr_command_list_s* list = bvr_pipeline_command_list(pipeline);
+    if(list){
+        if(bvri_reserve_commands(&list->commands, &list->capacity, list->count + 1)){
+            memcpy(&list->commands[list->count++], cmd, sizeof(struct bvr_draw_command_s));
+        }
+
+        return;
+    }
+
+    if(!bvri_reserve_commands(&pipeline->commands, &pipeline->command_capacity, pipeline->command_count + 1)){
+        return;
+    }
+
+    memcpy(&pipeline->commands[pipeline->command_count++], cmd, sizeof(struct bvr_draw_command_s));
+    pipeline->command_peak = MAX(pipeline->command_peak, pipeline->command_count);
+}
+
+int bvr_pipeline_begin_recording(bvr_pipeline_t* pipeline, const uint32 worker_count){
+    BVR_ASSERT(pipeline);
+    BVR_ASSERT(!pipeline->recording);
+
+    if(worker_count > pipeline->list_count){
+        struct bvr_command_list_s* lists = realloc(pipeline->lists, worker_count * sizeof(struct bvr_command_list_s));
+        if(!lists){
+            BVR_PRINT("failed to allocate command lists!");
+            return BVR_FALSE;
+        }
+
+        memset(&lists[pipeline->list_count], 0, (worker_count - pipeline->list_count) * sizeof(struct bvr_command_list_s));
+
+        // lists start with the same capacity as the pipeline's list
+        for (uint32 i = pipeline->list_count; i < worker_count; i++)
+        {
+            lists[i].commands = malloc(BVR_MAX_DRAW_COMMAND * sizeof(struct bvr_draw_command_s));
+            lists[i].capacity = lists[i].commands ? BVR_MAX_DRAW_COMMAND : 0;
+        }
+
+        pipeline->lists = lists;
+        pipeline->list_count = worker_count;
+    }
+
+    for (uint32 i = 0; i < pipeline->list_count; i++)
+    {
+        pipeline->lists[i].count = 0;
+    }
+
+    pipeline->recording = true;
+    return BVR_TRUE;
+}
+
+struct bvr_command_list_s* bvr_pipeline_command_list(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    const uint32 worker = bvr_job_worker_index();
+    if(!pipeline->recording || worker >= pipeline->list_count){
+        return NULL;
+    }
+
+    return &pipeline->lists[worker];
+}
+
+void bvr_pipeline_merge_commands(bvr_pipeline_t* pipeline, const struct bvr_command_list_s* list, const uint32 offset, const uint32 count){
+    BVR_ASSERT(pipeline);
+    BVR_ASSERT(list);
+    BVR_ASSERT(offset + count <= list->count);
+
+    if(!count || !bvri_reserve_commands(&pipeline->commands, &pipeline->command_capacity, pipeline->command_count + count)){
+        return;
+    }
+
+    memcpy(&pipeline->commands[pipeline->command_count], &list->commands[offset], count * sizeof(struct bvr_draw_command_s));
+    pipeline->command_count += count;
+    pipeline->command_peak = MAX(pipeline->command_peak, pipeline->command_count);
+}
+
+void bvr_pipeline_end_recording(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    for (uint32 i = 0; i < pipeline->list_count; i++)
+    {
+        pipeline->lists[i].count = 0;
+    }
+
+    pipeline->recording = false;
+}
+
+void bvr_destroy_command_lists(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    for (uint32 i = 0; i < pipeline->list_count; i++)
+    {
+        free(pipeline->lists[i].commands);
+    }
+
+    free(pipeline->lists);
+    pipeline->lists = NULL;
+    pipeline->list_count = 0;
+    pipeline->recording = false;
+}
+
+void bvr_pipeline_sort_commands(bvr_pipeline_t* pipeline, uint32* order){
+    BVR_ASSERT(pipeline);
+    BVR_ASSERT(order);
+
+    const uint32 count = pipeline->command_count;
+    uint64* keys = bvr_frame_alloc(count * 2 * sizeof(uint64));
+    uint32* scratch = bvr_frame_alloc(count * sizeof(uint32));
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+
+    if(!keys || !scratch){
+        BVR_PRINT("failed to sort draw commands!");
+        return;
+    }
+
+    // count each byte of the keys at once
+    uint32 histograms[sizeof(uint64)][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        keys[i] = pipeline->commands[i].key;
+
+        for (uint32 digit = 0; digit < sizeof(uint64); digit++)
+        {
+            histograms[digit][(keys[i] >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    uint64* src_keys = keys;
+    uint64* dst_keys = keys + count;
+    uint32* src = order;
+    uint32* dst = scratch;
+
+    // LSD radix sort, equal keys keep their submission order
+    for (uint32 digit = 0; digit < sizeof(uint64); digit++)
+    {
+        const uint32 shift = digit * 8;
+        uint32* histogram = histograms[digit];
+
+        // all commands share this byte
+        if(histogram[(src_keys[0] >> shift) & 0xFF] == count){
+            continue;
+        }
+
+        uint32 offset = 0;
+        for (uint32 i = 0; i < 256; i++)
+        {
+            const uint32 bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+
+        for (uint32 i = 0; i < count; i++)
+        {
+            const uint32 position = histogram[(src_keys[i] >> shift) & 0xFF]++;
+            dst_keys[position] = src_keys[i];
+            dst[position] = src[i];
+        }
+
+        uint64* swap_keys = src_keys;
+        src_keys = dst_keys;
+        dst_keys = swap_keys;
+
+        uint32* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if(src != order){
+        memcpy(order, src, count * sizeof(uint32));
     }
 }
 
@@ -132,6 +538,369 @@ void bvr_poll_errors(void){
     }
 }
 
+static struct bvr_gl_state_s __s_gl_state;
+
+void bvr_gl_state_reset(void){
+    const uint32 avoided = __s_gl_state.avoided;
+
+    memset(&__s_gl_state, 0xFF, sizeof(struct bvr_gl_state_s));
+    __s_gl_state.avoided = avoided;
+}
+
+void bvr_gl_state_forget(const uint32 object){
+    if(!object){
+        return;
+    }
+
+    uint32* values[] = {
+        &__s_gl_state.program, &__s_gl_state.vertex_array,
+        &__s_gl_state.array_buffer, &__s_gl_state.element_buffer, &__s_gl_state.uniform_buffer,
+        &__s_gl_state.read_framebuffer, &__s_gl_state.draw_framebuffer
+    };
+
+    // object names are not unique between object types, forgetting too much only costs a call
+    for (uint32 i = 0; i < sizeof(values) / sizeof(uint32*); i++)
+    {
+        if(*values[i] == object){
+            *values[i] = BVR_INVALID_INDEX;
+        }
+    }
+
+    for (uint32 i = 0; i < BVR_GL_MAX_TEXTURE_UNITS; i++)
+    {
+        if(__s_gl_state.textures[i].id == object){
+            __s_gl_state.textures[i].id = BVR_INVALID_INDEX;
+        }
+    }
+}
+
+uint32 bvr_gl_state_avoided_calls(void){
+    const uint32 avoided = __s_gl_state.avoided;
+    __s_gl_state.avoided = 0;
+
+    return avoided;
+}
+
+void bvr_gl_use_program(const uint32 program){
+    if(__s_gl_state.program == program){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glUseProgram(program);
+    __s_gl_state.program = program;
+}
+
+void bvr_gl_bind_vertex_array(const uint32 array){
+    if(__s_gl_state.vertex_array == array){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glBindVertexArray(array);
+    __s_gl_state.vertex_array = array;
+    __s_gl_state.element_buffer = BVR_INVALID_INDEX;
+}
+
+void bvr_gl_bind_buffer(const uint32 target, const uint32 buffer){
+    uint32* cached = NULL;
+
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        cached = &__s_gl_state.array_buffer;
+        break;
+
+    case GL_ELEMENT_ARRAY_BUFFER:
+        cached = &__s_gl_state.element_buffer;
+        break;
+
+    case GL_UNIFORM_BUFFER:
+        cached = &__s_gl_state.uniform_buffer;
+        break;
+    
+    default:
+        break;
+    }
+
+    if(cached && *cached == buffer){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glBindBuffer(target, buffer);
+
+    if(cached){
+        *cached = buffer;
+    }
+}
+
+void bvr_gl_bind_framebuffer(const uint32 target, const uint32 framebuffer){
+    const int read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    const int draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+
+    if((!read || __s_gl_state.read_framebuffer == framebuffer) &&
+       (!draw || __s_gl_state.draw_framebuffer == framebuffer)){
+        
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glBindFramebuffer(target, framebuffer);
+
+    if(read){
+        __s_gl_state.read_framebuffer = framebuffer;
+    }
+    if(draw){
+        __s_gl_state.draw_framebuffer = framebuffer;
+    }
+}
+
+void bvr_gl_active_texture(const uint32 unit){
+    if(__s_gl_state.active_texture == unit - BVR_TEXTURE_UNIT0){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glActiveTexture(unit);
+    __s_gl_state.active_texture = unit - BVR_TEXTURE_UNIT0;
+}
+
+void bvr_gl_bind_texture(const uint32 target, const uint32 texture){
+    const uint32 unit = __s_gl_state.active_texture;
+
+    // unknown or untracked unit
+    if(unit >= BVR_GL_MAX_TEXTURE_UNITS){
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if(__s_gl_state.textures[unit].target == target && __s_gl_state.textures[unit].id == texture){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glBindTexture(target, texture);
+    __s_gl_state.textures[unit].target = target;
+    __s_gl_state.textures[unit].id = texture;
+}
+
+void bvr_gl_enable(const uint32 capability){
+    uint32* cached = NULL;
+    
+    if(capability == GL_BLEND){
+        cached = &__s_gl_state.blending;
+    }
+    else if(capability == GL_DEPTH_TEST){
+        cached = &__s_gl_state.depth_testing;
+    }
+
+    if(cached && *cached == BVR_TRUE){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glEnable(capability);
+
+    if(cached){
+        *cached = BVR_TRUE;
+    }
+}
+
+void bvr_gl_disable(const uint32 capability){
+    uint32* cached = NULL;
+    
+    if(capability == GL_BLEND){
+        cached = &__s_gl_state.blending;
+    }
+    else if(capability == GL_DEPTH_TEST){
+        cached = &__s_gl_state.depth_testing;
+    }
+
+    if(cached && *cached == BVR_FALSE){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glDisable(capability);
+
+    if(cached){
+        *cached = BVR_FALSE;
+    }
+}
+
+void bvr_gl_blend_func(const uint32 src, const uint32 dst){
+    if(__s_gl_state.blend_src == src && __s_gl_state.blend_dst == dst){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glBlendFunc(src, dst);
+    __s_gl_state.blend_src = src;
+    __s_gl_state.blend_dst = dst;
+}
+
+void bvr_gl_depth_func(const uint32 func){
+    if(__s_gl_state.depth_func == func){
+        __s_gl_state.avoided++;
+        return;
+    }
+
+    glDepthFunc(func);
+    __s_gl_state.depth_func = func;
+}
+
+void bvr_destroy_instance_buffer(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    if(pipeline->instances.buffer){
+        bvr_gl_state_forget(pipeline->instances.buffer);
+        glDeleteBuffers(1, &pipeline->instances.buffer);
+    }
+
+    pipeline->instances.buffer = 0;
+    pipeline->instances.count = 0;
+}
+
+void bvr_pipeline_upload_objects(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    uint32 count = 0;
+    for (uint32 i = 0; i < pipeline->command_count; i++)
+    {
+        if(bvri_uses_object_buffer(&pipeline->commands[i])){
+            count++;
+        }
+    }
+
+    if(!count){
+        return;
+    }
+
+    if(!pipeline->objects.buffer){
+        int alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        alignment = MAX(alignment, 16);
+
+        glGenBuffers(1, &pipeline->objects.buffer);
+        pipeline->objects.stride = (sizeof(struct bvr_instance_s) + alignment - 1) / alignment * alignment;
+        pipeline->objects.region_size = 0;
+        pipeline->objects.cursor = 0;
+        pipeline->objects.region = 0;
+        pipeline->objects.bound = BVR_INVALID_INDEX;
+        memset(pipeline->objects.fences, 0, sizeof(pipeline->objects.fences));
+    }
+
+    bvr_gl_bind_buffer(GL_UNIFORM_BUFFER, pipeline->objects.buffer);
+
+    const uint64 size = (uint64)count * pipeline->objects.stride;
+    if(pipeline->objects.cursor + size > pipeline->objects.region_size){
+        uint64 region_size = MAX(pipeline->objects.region_size * 2, (uint64)BVR_OBJECT_BUFFER_SIZE * pipeline->objects.stride);
+        while (region_size < size)
+        {
+            region_size *= 2;
+        }
+
+        // regions are too small, orphan the buffer so frames in flight keep the previous storage
+        glBufferData(GL_UNIFORM_BUFFER, region_size * BVR_OBJECT_BUFFER_FRAMES, NULL, GL_STREAM_DRAW);
+
+        for (uint32 i = 0; i < BVR_OBJECT_BUFFER_FRAMES; i++)
+        {
+            if(pipeline->objects.fences[i]){
+                glDeleteSync((GLsync)pipeline->objects.fences[i]);
+                pipeline->objects.fences[i] = NULL;
+            }
+        }
+
+        pipeline->objects.region_size = region_size;
+        pipeline->objects.cursor = 0;
+        pipeline->objects.bound = BVR_INVALID_INDEX;
+    }
+
+    const uint64 base = pipeline->objects.region * pipeline->objects.region_size + pipeline->objects.cursor;
+
+    // the region's fence was waited on, the GPU does not read it anymore
+    char* objects = glMapBufferRange(GL_UNIFORM_BUFFER, base, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+    );
+
+    uint32 written = 0;
+    for (uint32 i = 0; i < pipeline->command_count; i++)
+    {
+        struct bvr_draw_command_s* cmd = &pipeline->commands[i];
+        if(!bvri_uses_object_buffer(cmd)){
+            continue;
+        }
+
+        if(!objects){
+            cmd->object_offset = BVR_INVALID_INDEX;
+            continue;
+        }
+
+        memcpy(objects + written * pipeline->objects.stride, cmd->instance, sizeof(struct bvr_instance_s));
+        cmd->object_offset = base + written * pipeline->objects.stride;
+        written++;
+    }
+
+    if(!objects){
+        BVR_PRINT("failed to map object buffer!");
+        return;
+    }
+
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+
+    pipeline->objects.cursor += size;
+    pipeline->stats.objects += written;
+}
+
+void bvr_pipeline_new_frame(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    if(!pipeline->objects.buffer){
+        return;
+    }
+
+    // fence the region written during the last frame
+    const uint32 region = pipeline->objects.region;
+    if(pipeline->objects.cursor){
+        pipeline->objects.fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    pipeline->objects.region = (region + 1) % BVR_OBJECT_BUFFER_FRAMES;
+    pipeline->objects.cursor = 0;
+
+    // only blocks if the GPU is more than BVR_OBJECT_BUFFER_FRAMES - 1 frames late
+    GLsync fence = (GLsync)pipeline->objects.fences[pipeline->objects.region];
+    if(fence){
+        GLenum status;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(fence);
+        pipeline->objects.fences[pipeline->objects.region] = NULL;
+    }
+}
+
+void bvr_destroy_object_buffer(bvr_pipeline_t* pipeline){
+    BVR_ASSERT(pipeline);
+
+    for (uint32 i = 0; i < BVR_OBJECT_BUFFER_FRAMES; i++)
+    {
+        if(pipeline->objects.fences[i]){
+            glDeleteSync((GLsync)pipeline->objects.fences[i]);
+        }
+    }
+
+    if(pipeline->objects.buffer){
+        bvr_gl_state_forget(pipeline->objects.buffer);
+        glDeleteBuffers(1, &pipeline->objects.buffer);
+    }
+
+    memset(&pipeline->objects, 0, sizeof(pipeline->objects));
+    pipeline->objects.bound = BVR_INVALID_INDEX;
+}
+
 int bvr_create_framebuffer(bvr_framebuffer_t* framebuffer, const uint16 width, const uint16 height, const char* shader){
     BVR_ASSERT(framebuffer);
     BVR_ASSERT(width > 0 && height > 0);
@@ -155,10 +924,10 @@ int bvr_create_framebuffer(bvr_framebuffer_t* framebuffer, const uint16 width, c
         };
 
         glGenVertexArrays(1, &framebuffer->vertex_buffer);
-        glBindVertexArray(framebuffer->vertex_buffer);
+        bvr_gl_bind_vertex_array(framebuffer->vertex_buffer);
 
         glGenBuffers(1, &framebuffer->array_buffer);
-        glBindBuffer(GL_ARRAY_BUFFER, framebuffer->array_buffer);
+        bvr_gl_bind_buffer(GL_ARRAY_BUFFER, framebuffer->array_buffer);
 
         glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), &quad, GL_STATIC_DRAW);
 
@@ -173,10 +942,10 @@ int bvr_create_framebuffer(bvr_framebuffer_t* framebuffer, const uint16 width, c
     }
 
     glGenFramebuffers(1, &framebuffer->buffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->buffer);
+    bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, framebuffer->buffer);
 
     glGenTextures(1, &framebuffer->color_buffer);
-    glBindTexture(GL_TEXTURE_2D, framebuffer->color_buffer);
+    bvr_gl_bind_texture(GL_TEXTURE_2D, framebuffer->color_buffer);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -193,8 +962,8 @@ int bvr_create_framebuffer(bvr_framebuffer_t* framebuffer, const uint16 width, c
     }
 
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bvr_gl_bind_texture(GL_TEXTURE_2D, 0);
+    bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
 
     return BVR_TRUE;
 }
@@ -202,7 +971,7 @@ int bvr_create_framebuffer(bvr_framebuffer_t* framebuffer, const uint16 width, c
 void bvr_framebuffer_enable(bvr_framebuffer_t* framebuffer){
     int viewport[4];
 
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->buffer);
+    bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, framebuffer->buffer);
     glGetIntegerv(GL_VIEWPORT, viewport);
     framebuffer->target_width = viewport[2];
     framebuffer->target_height = viewport[3];
@@ -214,7 +983,7 @@ void bvr_framebuffer_enable(bvr_framebuffer_t* framebuffer){
 }
 
 void bvr_framebuffer_disable(bvr_framebuffer_t* framebuffer){
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
     glViewport(0, 0, framebuffer->target_width, framebuffer->target_height);
 
     // update pipeline state
@@ -247,26 +1016,21 @@ void bvr_framebuffer_blit(bvr_framebuffer_t* framebuffer){
     glClear(GL_COLOR_BUFFER_BIT);
     bvr_shader_enable(shader);
 
-    glBindVertexArray(framebuffer->vertex_buffer);
-    glBindTexture(GL_TEXTURE_2D, framebuffer->color_buffer);
-
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
+    bvr_gl_bind_vertex_array(framebuffer->vertex_buffer);
+    bvr_gl_active_texture(BVR_TEXTURE_UNIT0);
+    bvr_gl_bind_texture(GL_TEXTURE_2D, framebuffer->color_buffer);
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    glDisableVertexAttribArray(1);
-    glDisableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    bvr_shader_disable();
 }
 
 void bvr_destroy_framebuffer(bvr_framebuffer_t* framebuffer){
     bvr_destroy_shader(&framebuffer->shader);
 
+    bvr_gl_state_forget(framebuffer->vertex_buffer);
+    bvr_gl_state_forget(framebuffer->array_buffer);
+    bvr_gl_state_forget(framebuffer->color_buffer);
+    bvr_gl_state_forget(framebuffer->buffer);
+
     glDeleteVertexArrays(1, &framebuffer->vertex_buffer);
     glDeleteBuffers(1, &framebuffer->array_buffer);
     glDeleteTextures(1, &framebuffer->color_buffer);
@@ -391,6 +1155,63 @@ void bvr_create_predefs(struct bvr_predefs* predefs){
             BVR_VERTEX_SHADER | BVR_FRAGMENT_SHADER
         );
     }
+
+    /* sprite shaders */
+    {
+        vertex_shader = "#version 400\n"
+            "layout(location=0) in vec3 in_position;\n"
+            "layout(location=1) in vec3 in_uvs;\n"
+            "layout(location=2) in vec4 in_color;\n"
+            "layout(std140) uniform bvr_camera {"
+            "	mat4 bvr_projection;"
+            "	mat4 bvr_view;"
+            "};"
+            "out V_DATA {\n"
+            "	vec3 uvs;\n"
+            "	vec4 color;\n"
+            "} vertex;\n"
+            "void main() {\n"
+            "	gl_Position = bvr_projection * bvr_view * vec4(in_position, 1.0);\n"
+            "	vertex.uvs = in_uvs;\n"
+            "	vertex.color = in_color;\n"
+            "}";
+        
+        fragment_shader = "#version 400\n"
+            "in V_DATA {\n"
+            "vec3 uvs;\n"
+            "vec4 color;\n"
+            "} vertex;\n"
+            "uniform sampler2D bvr_texture;\n"
+            "void main() {\n"
+            	"gl_FragColor = texture(bvr_texture, vertex.uvs.xy) * vertex.color;\n"
+            "}";
+
+        shader_array[0] = vertex_shader;
+        shader_array[1] = fragment_shader;
+
+        predefs->is_available &= bvr_create_shader_raw(&predefs->c_shaders.c_sprite_shader, 
+            (const char**)shader_array, 
+            BVR_VERTEX_SHADER | BVR_FRAGMENT_SHADER
+        );
+
+        // atlases sample their layer
+        fragment_shader = "#version 400\n"
+            "in V_DATA {\n"
+            "vec3 uvs;\n"
+            "vec4 color;\n"
+            "} vertex;\n"
+            "uniform sampler2DArray bvr_texture;\n"
+            "void main() {\n"
+            	"gl_FragColor = texture(bvr_texture, vertex.uvs) * vertex.color;\n"
+            "}";
+
+        shader_array[1] = fragment_shader;
+
+        predefs->is_available &= bvr_create_shader_raw(&predefs->c_shaders.c_sprite_atlas_shader, 
+            (const char**)shader_array, 
+            BVR_VERTEX_SHADER | BVR_FRAGMENT_SHADER
+        );
+    }
 }
 
 void bvr_destroy_predefs(struct bvr_predefs* predefs){
@@ -399,6 +1220,8 @@ void bvr_destroy_predefs(struct bvr_predefs* predefs){
     bvr_destroy_shader(&predefs->c_shaders.c_invalid_shader);
     bvr_destroy_shader(&predefs->c_shaders.c_framebuffer_shader);
     bvr_destroy_shader(&predefs->c_shaders.c_composite_shader);
+    bvr_destroy_shader(&predefs->c_shaders.c_sprite_shader);
+    bvr_destroy_shader(&predefs->c_shaders.c_sprite_atlas_shader);
 
     predefs->is_available = false;
 }
@@ -407,72 +1230,72 @@ static void bvri_pipeline_restore_blending(struct bvr_pipeline_state_s* const st
     BVR_ASSERT(state);
 
     if(state->blending){
-        glEnable(GL_BLEND);
+        bvr_gl_enable(GL_BLEND);
         switch(state->blending)
         {
         case BVR_BLEND_FUNC_ALPHA_ONE_MINUS:
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            bvr_gl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             break;
         case BVR_BLEND_FUNC_ALPHA_ADD:
-            glBlendFunc(GL_ONE, GL_ONE);
+            bvr_gl_blend_func(GL_ONE, GL_ONE);
             break;
         case BVR_BLEND_FUNC_ALPHA_MULT:
-            glBlendFunc(GL_ONE, GL_SRC_COLOR);
+            bvr_gl_blend_func(GL_ONE, GL_SRC_COLOR);
             break;
         default:
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            bvr_gl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             break;
         }
     }
     else {
-        glDisable(GL_BLEND);
+        bvr_gl_disable(GL_BLEND);
     }
 }
 
 static void bvri_pipeline_restore_depth(struct bvr_pipeline_state_s* const state){
     if(state->depth){
-        glEnable(GL_DEPTH_TEST);
+        bvr_gl_enable(GL_DEPTH_TEST);
 
         switch (state->depth)
         {
         case BVR_DEPTH_FUNC_NEVER:
-            glDepthFunc(GL_NEVER);
+            bvr_gl_depth_func(GL_NEVER);
             break;
         
         case BVR_DEPTH_FUNC_ALWAYS:
-            glDepthFunc(GL_ALWAYS);
+            bvr_gl_depth_func(GL_ALWAYS);
             break;
         
         case BVR_DEPTH_FUNC_LESS:
-            glDepthFunc(GL_LESS);
+            bvr_gl_depth_func(GL_LESS);
             break;
     
         case BVR_DEPTH_FUNC_GREATER:
-            glDepthFunc(GL_GREATER);
+            bvr_gl_depth_func(GL_GREATER);
             break;
 
         case BVR_DEPTH_FUNC_LEQUAL:
-            glDepthFunc(GL_LEQUAL);
+            bvr_gl_depth_func(GL_LEQUAL);
             break;
         
         case BVR_DEPTH_FUNC_GEQUAL:
-            glDepthFunc(GL_GEQUAL);
+            bvr_gl_depth_func(GL_GEQUAL);
             break;
 
         case BVR_DEPTH_FUNC_NOTEQUAL:
-            glDepthFunc(GL_NOTEQUAL);
+            bvr_gl_depth_func(GL_NOTEQUAL);
             break;
         
         case BVR_DEPTH_FUNC_EQUAL:
-            glDepthFunc(GL_EQUAL);
+            bvr_gl_depth_func(GL_EQUAL);
             break;
 
         default:
-            glDepthFunc(GL_ALWAYS);
+            bvr_gl_depth_func(GL_ALWAYS);
             break;
         }
     }
     else {
-        glDisable(GL_DEPTH_TEST);
+        bvr_gl_disable(GL_DEPTH_TEST);
     }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <BVR/gui.h>
 #include <BVR/common.h>
+#include <BVR/graphics.h>
 
 #ifdef BVR_INCLUDE_NUKLEAR
 
@@ -126,6 +127,9 @@ void bvr_nuklear_render(bvr_nuklear_t* nuklear){
         nuklear->element_buffer_length, 
         nuklear->scale
     );
+
+    // nuklear does not use the state cache
+    bvr_gl_state_reset();
 }
 
 void bvr_destroy_nuklear(bvr_nuklear_t* nuklear){
@@ -137,7 +141,7 @@ void bvr_destroy_nuklear(bvr_nuklear_t* nuklear){
 void bvr_nuklear_actor_label(bvr_nuklear_t* nuklear, struct bvr_actor_s* actor){
     BVR_ASSERT(nuklear);
     if(((struct nk_context*)nuklear->context)->begin){
-        bvr_nuklear_vec3_label(nuklear, actor->name.string, actor->transform.position);
+        bvr_nuklear_vec3_label(nuklear, bvr_atom_string(actor->name), actor->transform.position);
     }
 }
 
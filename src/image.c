@@ -1417,7 +1417,7 @@ void bvr_destroy_image(bvr_image_t* image){
 
 static int bvri_create_texture_base(bvr_texture_t* texture){
     glGenTextures(1, &texture->id);
-    glBindTexture(texture->target, texture->id);
+    bvr_gl_bind_texture(texture->target, texture->id);
     
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glPixelStorei(GL_UNPACK_ROW_LENGTH, texture->image.width);
@@ -1479,7 +1479,7 @@ int bvr_create_view_texture(bvr_texture_t* origin, bvr_texture_t* dest, int widt
         glGenerateMipmap(dest->target);
     }
 
-    glBindTexture(dest->target, 0);
+    bvr_gl_bind_texture(dest->target, 0);
     
     return BVR_TRUE;
 }
@@ -1516,7 +1516,7 @@ int bvr_create_texture_from_image(bvr_texture_t* texture, bvr_image_t* image, in
 
     glGenerateMipmap(texture->target);
 
-    glBindTexture(texture->target, 0);
+    bvr_gl_bind_texture(texture->target, 0);
 
     free(image->pixels);
     image->pixels = NULL;
@@ -1538,17 +1538,18 @@ int bvr_create_texturef(bvr_texture_t* texture, FILE* file, int filter, int wrap
 }
 
 void bvr_texture_enable(bvr_texture_t* texture){
-    glActiveTexture(BVR_TEXTURE_UNIT0 + texture->unit);
-    glBindTexture(texture->target, texture->id);
+    bvr_gl_active_texture(BVR_TEXTURE_UNIT0 + texture->unit);
+    bvr_gl_bind_texture(texture->target, texture->id);
 }
 
 void bvr_texture_disable(bvr_texture_t* texture){
-    glBindTexture(texture->target, 0);
+    bvr_gl_bind_texture(texture->target, 0);
 }
 
 void bvr_destroy_texture(bvr_texture_t* texture){
     BVR_ASSERT(texture);
 
+    bvr_gl_state_forget(texture->id);
     glDeleteTextures(1, &texture->id);
     
     bvr_destroy_image(&texture->image);
@@ -1626,7 +1627,7 @@ int bvr_create_texture_atlasf(bvr_texture_atlas_t* atlas, FILE* file,
     
     glGenerateMipmap(atlas->texture.target);
 
-    glBindTexture(atlas->texture.target, 0);
+    bvr_gl_bind_texture(atlas->texture.target, 0);
     
     free(atlas->texture.image.pixels);
     atlas->texture.image.pixels = NULL;
@@ -1697,7 +1698,7 @@ int bvr_create_layered_texturef(bvr_texture_t* texture, FILE* file, int filter,
 
     glGenerateMipmap(texture->target);
     
-    glBindTexture(texture->target, 0);
+    bvr_gl_bind_texture(texture->target, 0);
 
     free(texture->image.pixels);
     texture->image.pixels = NULL;
@@ -1719,10 +1720,10 @@ int bvr_create_composite(bvr_composite_t* composite, bvr_image_t* target){
     composite->image = target;
 
     glGenFramebuffers(1, &composite->framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, composite->framebuffer);
+    bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, composite->framebuffer);
 
     glGenTextures(1, &composite->tex);
-    glBindTexture(GL_TEXTURE_2D, composite->tex);
+    bvr_gl_bind_texture(GL_TEXTURE_2D, composite->tex);
     glTexImage2D(
         GL_TEXTURE_2D, 0, 
         GL_RGB, 
@@ -1742,16 +1743,16 @@ int bvr_create_composite(bvr_composite_t* composite, bvr_image_t* target){
         return BVR_FALSE;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
+    bvr_gl_bind_texture(GL_TEXTURE_2D, 0);
 
     return BVR_TRUE;
 }
 
-void bvr_composite_enable(bvr_composite_t* composite, bvr_transform_t* const transform){
+void bvr_composite_enable(bvr_composite_t* composite, vec4* const matrix){
     BVR_ASSERT(composite && composite->framebuffer);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, composite->framebuffer);
+    bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, composite->framebuffer);
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -1759,9 +1760,9 @@ void bvr_composite_enable(bvr_composite_t* composite, bvr_transform_t* const tra
     glViewport(0, 0, composite->image->width, composite->image->height);
 
     // try to copy previous framebuffer content onto the current framebuffer
-    if(bvr_get_instance()->pipeline.state.framebuffer && transform){
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, bvr_get_instance()->pipeline.state.framebuffer->buffer);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, composite->framebuffer);
+    if(bvr_get_instance()->pipeline.state.framebuffer && matrix){
+        bvr_gl_bind_framebuffer(GL_READ_FRAMEBUFFER, bvr_get_instance()->pipeline.state.framebuffer->buffer);
+        bvr_gl_bind_framebuffer(GL_DRAW_FRAMEBUFFER, composite->framebuffer);
 
         float hw = composite->image->width * 0.5f;
         float hh = composite->image->height * 0.5f;
@@ -1779,8 +1780,8 @@ void bvr_composite_enable(bvr_composite_t* composite, bvr_transform_t* const tra
         world1[2] = 0.0f;
         world1[3] = 0.0f;
 
-        mat4_mul_vec4(world0, transform->matrix, world0);
-        mat4_mul_vec4(world1, transform->matrix, world1);
+        mat4_mul_vec4(world0, matrix, world0);
+        mat4_mul_vec4(world1, matrix, world1);
 
         bvr_world_to_screen(&bvr_get_instance()->page.camera, world0, src0);
         bvr_world_to_screen(&bvr_get_instance()->page.camera, world1, src1);
@@ -1791,23 +1792,23 @@ void bvr_composite_enable(bvr_composite_t* composite, bvr_transform_t* const tra
             GL_COLOR_BUFFER_BIT, GL_LINEAR
         );
 
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-        glBindFramebuffer(GL_FRAMEBUFFER, composite->framebuffer);
+        bvr_gl_bind_framebuffer(GL_READ_FRAMEBUFFER, 0);
+        bvr_gl_bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, composite->framebuffer);
     }
 }
 
 void bvr_composite_prepare(bvr_composite_t* composite){
     BVR_ASSERT(composite);
     
-    glBindTexture(GL_TEXTURE_2D, composite->tex);
-    glActiveTexture(GL_TEXTURE0);
+    bvr_gl_bind_texture(GL_TEXTURE_2D, composite->tex);
+    bvr_gl_active_texture(GL_TEXTURE0);
 }
 
 void bvr_composite_disable(bvr_composite_t* composite){
     // if there is a working framebuffer
     if(bvr_get_instance()->pipeline.state.framebuffer){
-        glBindFramebuffer(GL_FRAMEBUFFER, bvr_get_instance()->pipeline.state.framebuffer->buffer);
+        bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, bvr_get_instance()->pipeline.state.framebuffer->buffer);
         glViewport(0, 0, 
             bvr_get_instance()->pipeline.state.framebuffer->width, 
             bvr_get_instance()->pipeline.state.framebuffer->height
@@ -1815,7 +1816,7 @@ void bvr_composite_disable(bvr_composite_t* composite){
     }
     // use default framebuffer and window's screen size
     else {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        bvr_gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
         glViewport(0, 0, 
             bvr_get_instance()->window.framebuffer.width, 
             bvr_get_instance()->window.framebuffer.height
@@ -1826,6 +1827,9 @@ void bvr_composite_disable(bvr_composite_t* composite){
 void bvr_destroy_composite(bvr_composite_t* composite){
     BVR_ASSERT(composite);
 
+    bvr_gl_state_forget(composite->framebuffer);
+    bvr_gl_state_forget(composite->tex);
+
     glDeleteFramebuffers(1, &composite->framebuffer);
     glDeleteTextures(1, &composite->tex);
 
@@ -0,0 +1,451 @@
+#include <BVR/jobs.h>
+
+#include <BVR/buffer.h>
+#include <BVR/math.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#ifdef _WIN32
+    #include <Windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define BVRI_JOB_QUEUE_MASK (BVR_JOB_QUEUE_SIZE - 1)
+
+/*
+    Batch of a `bvr_parallel_for`
+*/
+struct bvri_job_range_s {
+    bvr_job_range_func_t func;
+    void* data;
+
+    uint32 begin;
+    uint32 end;
+};
+
+// calling thread's worker
+static __thread bvr_job_system_t* bvri_worker_system = NULL;
+static __thread uint32 bvri_worker_index = BVR_INVALID_INDEX;
+
+static uint32 bvri_get_core_count(void){
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32)count : 1;
+#endif
+}
+
+/*
+    Deque slots can be read by a thief while the owner reuses them,
+    the thief's copy is then dropped by its failed CAS on top.
+*/
+static void bvri_store_job(struct bvr_job_s* slot, const struct bvr_job_s* job){
+    __atomic_store_n(&slot->func, job->func, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->data, job->data, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->counter, job->counter, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->dependency, job->dependency, __ATOMIC_RELAXED);
+}
+
+static void bvri_load_job(struct bvr_job_s* job, struct bvr_job_s* slot){
+    job->func = __atomic_load_n(&slot->func, __ATOMIC_RELAXED);
+    job->data = __atomic_load_n(&slot->data, __ATOMIC_RELAXED);
+    job->counter = __atomic_load_n(&slot->counter, __ATOMIC_RELAXED);
+    job->dependency = __atomic_load_n(&slot->dependency, __ATOMIC_RELAXED);
+}
+
+/*
+    Push a job at the bottom of the deque, only called by deque's owner.
+    Returns BVR_FALSE if the deque is full.
+*/
+static int bvri_deque_push(struct bvr_job_deque_s* deque, const struct bvr_job_s* job){
+    const int64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    const int64 top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+
+    if(bottom - top >= BVR_JOB_QUEUE_SIZE){
+        return BVR_FALSE;
+    }
+
+    bvri_store_job(&deque->jobs[bottom & BVRI_JOB_QUEUE_MASK], job);
+
+    // job must be visible before the new bottom
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+
+    return BVR_TRUE;
+}
+
+/*
+    Pop the last pushed job, only called by deque's owner.
+*/
+static int bvri_deque_pop(struct bvr_job_deque_s* deque, struct bvr_job_s* job){
+    const int64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    int64 top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+    // deque is empty
+    if(top > bottom){
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return BVR_FALSE;
+    }
+
+    bvri_load_job(job, &deque->jobs[bottom & BVRI_JOB_QUEUE_MASK]);
+    if(top != bottom){
+        return BVR_TRUE;
+    }
+
+    // last job, thieves might take it first
+    const int taken = __atomic_compare_exchange_n(&deque->top, &top, top + 1, BVR_FALSE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+
+    return taken;
+}
+
+/*
+    Take the oldest job of another worker's deque.
+*/
+static int bvri_deque_steal(struct bvr_job_deque_s* deque, struct bvr_job_s* job){
+    int64 top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    const int64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+
+    if(top >= bottom){
+        return BVR_FALSE;
+    }
+
+    bvri_load_job(job, &deque->jobs[top & BVRI_JOB_QUEUE_MASK]);
+    return __atomic_compare_exchange_n(&deque->top, &top, top + 1, BVR_FALSE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+/*
+    Get calling thread's worker, NULL if the thread does not belong to `system`.
+*/
+static struct bvr_job_worker_s* bvri_get_worker(bvr_job_system_t* system){
+    if(bvri_worker_system != system || bvri_worker_index >= system->worker_count){
+        return NULL;
+    }
+
+    return &system->workers[bvri_worker_index];
+}
+
+static void bvri_enqueue_job(bvr_job_system_t* system, struct bvr_job_s* job);
+
+/*
+    Queue deferred jobs whose dependency has been completed.
+*/
+static void bvri_release_deferred(bvr_job_system_t* system){
+    struct bvr_job_s job;
+
+    // jobs are queued outside of the lock, because they might run right away
+    while (BVR_TRUE)
+    {
+        int found = BVR_FALSE;
+
+        pthread_mutex_lock(&system->lock);
+        for (uint32 i = 0; i < system->deferred_count; i++)
+        {
+            if(__atomic_load_n(&system->deferred[i].dependency->value, __ATOMIC_ACQUIRE) <= 0){
+                memcpy(&job, &system->deferred[i], sizeof(struct bvr_job_s));
+                memcpy(&system->deferred[i], &system->deferred[--system->deferred_count], sizeof(struct bvr_job_s));
+
+                found = BVR_TRUE;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&system->lock);
+
+        if(!found){
+            return;
+        }
+
+        bvri_enqueue_job(system, &job);
+    }
+}
+
+static void bvri_execute_job(bvr_job_system_t* system, struct bvr_job_s* job){
+    job->func(job->data);
+
+    if(job->counter && __atomic_sub_fetch(&job->counter->value, 1, __ATOMIC_ACQ_REL) == 0){
+        bvri_release_deferred(system);
+    }
+}
+
+/*
+    Push a job inside calling worker's deque.
+    Threads that are not workers, and full deques, run the job right away.
+*/
+static void bvri_enqueue_job(bvr_job_system_t* system, struct bvr_job_s* job){
+    struct bvr_job_worker_s* worker = bvri_get_worker(system);
+
+    // pending is incremented first, so that it never goes below the number of queued jobs
+    __atomic_add_fetch(&system->pending, 1, __ATOMIC_SEQ_CST);
+
+    if(!worker || !bvri_deque_push(&worker->deque, job)){
+        __atomic_sub_fetch(&system->pending, 1, __ATOMIC_SEQ_CST);
+        bvri_execute_job(system, job);
+        return;
+    }
+
+    if(__atomic_load_n(&system->sleeping, __ATOMIC_SEQ_CST) > 0){
+        pthread_mutex_lock(&system->lock);
+        pthread_cond_signal(&system->wake);
+        pthread_mutex_unlock(&system->lock);
+    }
+}
+
+/*
+    Run one job from worker's deque, or stolen from another worker.
+    Returns BVR_FALSE if there was nothing to run.
+*/
+static int bvri_run_job(bvr_job_system_t* system, struct bvr_job_worker_s* worker){
+    struct bvr_job_s job;
+    int found = bvri_deque_pop(&worker->deque, &job);
+
+    // start from a random victim, so that thieves do not all target the same worker
+    const uint32 start = (uint32)bvr_random_next(&worker->random);
+    for (uint32 i = 0; !found && i < system->worker_count; i++)
+    {
+        const uint32 victim = (start + i) % system->worker_count;
+        if(victim != worker->index){
+            found = bvri_deque_steal(&system->workers[victim].deque, &job);
+        }
+    }
+
+    if(!found){
+        return BVR_FALSE;
+    }
+
+    __atomic_sub_fetch(&system->pending, 1, __ATOMIC_SEQ_CST);
+    bvri_execute_job(system, &job);
+
+    return BVR_TRUE;
+}
+
+static void* bvri_worker_main(void* arg){
+    struct bvr_job_worker_s* worker = (struct bvr_job_worker_s*)arg;
+    bvr_job_system_t* system = worker->system;
+
+    bvri_worker_system = system;
+    bvri_worker_index = worker->index;
+
+    while (__atomic_load_n(&system->running, __ATOMIC_ACQUIRE))
+    {
+        if(bvri_run_job(system, worker)){
+            continue;
+        }
+
+        // sleep until a job is pushed
+        pthread_mutex_lock(&system->lock);
+        __atomic_add_fetch(&system->sleeping, 1, __ATOMIC_SEQ_CST);
+
+        while (__atomic_load_n(&system->pending, __ATOMIC_SEQ_CST) <= 0 &&
+            __atomic_load_n(&system->running, __ATOMIC_ACQUIRE)){
+
+            pthread_cond_wait(&system->wake, &system->lock);
+        }
+
+        __atomic_sub_fetch(&system->sleeping, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&system->lock);
+    }
+
+    return NULL;
+}
+
+int bvr_create_job_system(bvr_job_system_t* system, uint32 thread_count){
+    BVR_ASSERT(system);
+
+    memset(system, 0, sizeof(bvr_job_system_t));
+
+    if(!thread_count){
+        const uint32 core_count = bvri_get_core_count();
+        thread_count = core_count > 1 ? core_count - 1 : 0;
+    }
+
+    system->workers = calloc(thread_count + 1, sizeof(struct bvr_job_worker_s));
+    if(!system->workers){
+        BVR_PRINT("failed to allocate job workers!");
+        return BVR_FALSE;
+    }
+
+    pthread_mutex_init(&system->lock, NULL);
+    pthread_cond_init(&system->wake, NULL);
+
+    system->worker_count = thread_count + 1;
+    system->running = BVR_TRUE;
+
+    for (uint32 i = 0; i < system->worker_count; i++)
+    {
+        system->workers[i].system = system;
+        system->workers[i].index = i;
+        bvr_create_random(&system->workers[i].random, (uint64)(size_t)&system->workers[i] ^ i);
+    }
+
+    // calling thread is the first worker
+    bvri_worker_system = system;
+    bvri_worker_index = 0;
+
+    for (uint32 i = 1; i < system->worker_count; i++)
+    {
+        if(pthread_create(&system->workers[i].thread, NULL, bvri_worker_main, &system->workers[i]) != 0){
+            BVR_PRINTF("failed to create job worker %i!", i);
+
+            system->worker_count = i;
+            break;
+        }
+    }
+
+    return BVR_TRUE;
+}
+
+void bvr_job_push(bvr_job_system_t* system, bvr_job_func_t func, void* data, bvr_job_counter_t* counter){
+    bvr_job_push_after(system, func, data, counter, NULL);
+}
+
+void bvr_job_push_after(bvr_job_system_t* system, bvr_job_func_t func, void* data,
+    bvr_job_counter_t* counter, bvr_job_counter_t* dependency){
+
+    BVR_ASSERT(system);
+    BVR_ASSERT(func);
+
+    struct bvr_job_s job;
+    job.func = func;
+    job.data = data;
+    job.counter = counter;
+    job.dependency = dependency;
+
+    if(counter){
+        __atomic_add_fetch(&counter->value, 1, __ATOMIC_ACQ_REL);
+    }
+
+    if(dependency){
+        pthread_mutex_lock(&system->lock);
+
+        // dependency is checked under the lock, bvri_release_deferred cannot miss this job
+        if(__atomic_load_n(&dependency->value, __ATOMIC_ACQUIRE) > 0){
+            if(system->deferred_count == system->deferred_capacity){
+                const uint32 capacity = MAX(system->deferred_capacity * 2, 16);
+                struct bvr_job_s* deferred = realloc(system->deferred, capacity * sizeof(struct bvr_job_s));
+
+                if(!deferred){
+                    pthread_mutex_unlock(&system->lock);
+                    BVR_PRINT("failed to defer job, waiting for its dependency!");
+
+                    bvr_job_wait(system, dependency);
+                    bvri_enqueue_job(system, &job);
+                    return;
+                }
+
+                system->deferred = deferred;
+                system->deferred_capacity = capacity;
+            }
+
+            memcpy(&system->deferred[system->deferred_count++], &job, sizeof(struct bvr_job_s));
+            pthread_mutex_unlock(&system->lock);
+            return;
+        }
+
+        pthread_mutex_unlock(&system->lock);
+    }
+
+    bvri_enqueue_job(system, &job);
+}
+
+void bvr_job_wait(bvr_job_system_t* system, bvr_job_counter_t* counter){
+    BVR_ASSERT(system);
+    BVR_ASSERT(counter);
+
+    struct bvr_job_worker_s* worker = bvri_get_worker(system);
+
+    // help other workers instead of sleeping
+    while (__atomic_load_n(&counter->value, __ATOMIC_ACQUIRE) > 0)
+    {
+        if(!worker || !bvri_run_job(system, worker)){
+            sched_yield();
+        }
+    }
+}
+
+static void bvri_run_range(void* data){
+    struct bvri_job_range_s* range = (struct bvri_job_range_s*)data;
+    range->func(range->data, range->begin, range->end);
+}
+
+void bvr_parallel_for(bvr_job_system_t* system, const uint32 count, const uint32 batch_size,
+    bvr_job_range_func_t func, void* data){
+
+    BVR_ASSERT(system);
+    BVR_ASSERT(func);
+
+    if(!count){
+        return;
+    }
+
+    // bigger batches when the range would need too many jobs
+    uint32 size = MAX(batch_size, 1);
+    size = MAX(size, (count + BVR_JOB_MAX_BATCHES - 1) / BVR_JOB_MAX_BATCHES);
+
+    const uint32 batch_count = (count + size - 1) / size;
+    if(batch_count <= 1 || system->worker_count <= 1 || !bvri_get_worker(system)){
+        func(data, 0, count);
+        return;
+    }
+
+    struct bvri_job_range_s ranges[BVR_JOB_MAX_BATCHES];
+    bvr_job_counter_t counter = {0};
+
+    // first batch is run by the calling thread
+    for (uint32 i = 1; i < batch_count; i++)
+    {
+        ranges[i].func = func;
+        ranges[i].data = data;
+        ranges[i].begin = i * size;
+        ranges[i].end = MIN(count, (i + 1) * size);
+
+        bvr_job_push(system, bvri_run_range, &ranges[i], &counter);
+    }
+
+    func(data, 0, size);
+    bvr_job_wait(system, &counter);
+}
+
+uint32 bvr_job_worker_index(void){
+    return bvri_worker_index;
+}
+
+void bvr_destroy_job_system(bvr_job_system_t* system){
+    BVR_ASSERT(system);
+
+    if(!system->workers){
+        return;
+    }
+
+    pthread_mutex_lock(&system->lock);
+    __atomic_store_n(&system->running, BVR_FALSE, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&system->wake);
+    pthread_mutex_unlock(&system->lock);
+
+    for (uint32 i = 1; i < system->worker_count; i++)
+    {
+        pthread_join(system->workers[i].thread, NULL);
+    }
+
+    pthread_mutex_destroy(&system->lock);
+    pthread_cond_destroy(&system->wake);
+
+    free(system->workers);
+    free(system->deferred);
+
+    if(bvri_worker_system == system){
+        bvri_worker_system = NULL;
+        bvri_worker_index = BVR_INVALID_INDEX;
+    }
+
+    memset(system, 0, sizeof(bvr_job_system_t));
+}
@@ -3,6 +3,7 @@
 #include <BVR/buffer.h>
 #include <BVR/file.h>
 #include <BVR/physics.h>
+#include <BVR/graphics.h>
 
 #include <malloc.h>
 #include <string.h>
@@ -26,6 +27,14 @@
 static int bvri_create_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint64 element_size, 
     int vertex_type, int element_type, bvr_mesh_array_attrib_t attrib);
 
+/*
+    Set mesh's bounds to an empty box, meshes without vertices are unbounded.
+*/
+static void bvri_clear_mesh_bounds(bvr_mesh_t* mesh){
+    BVR_SCALE_VEC3(mesh->bounds.min, INFINITY);
+    BVR_SCALE_VEC3(mesh->bounds.max, -INFINITY);
+}
+
 #ifndef BVR_NO_OBJ
 
 struct bvri_objobject_s {
@@ -232,10 +241,10 @@ static int bvri_load_obj(bvr_mesh_t* mesh, FILE* file){
 
     // create vertex groups
     // copy created groups
-    bvr_create_pool(&mesh->vertex_groups, sizeof(bvr_vertex_group_t), object.group_count);
+    bvr_create_slotmap(&mesh->vertex_groups, sizeof(bvr_vertex_group_t), object.group_count);
     for (size_t i = 0; i < object.group_count; i++)
     {
-        bvr_vertex_group_t* group = bvr_pool_alloc(&mesh->vertex_groups);
+        bvr_vertex_group_t* group = bvr_slotmap_alloc(&mesh->vertex_groups, NULL);
         group->name.length = object.groups[i].name.length;
         group->name.string = object.groups[i].name.string;
         group->element_count = object.groups[i].element_count;
@@ -245,8 +254,8 @@ static int bvri_load_obj(bvr_mesh_t* mesh, FILE* file){
         BVR_IDENTITY_MAT4(group->matrix);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
 
     // copy data to opengl buffers
     uint64 vertex = 0, element = 0;
@@ -277,8 +286,14 @@ static int bvri_load_obj(bvr_mesh_t* mesh, FILE* file){
         
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // compute local bounds
+    for (uint64 i = 0; i < object.vertex_count; i++)
+    {
+        bvr_aabb_extend(&mesh->bounds, object.vertex[i]);
+    }
 
     bvr_destroy_string(&object.name);
     bvr_destroy_string(&object.material);
@@ -411,6 +426,7 @@ static int bvri_gltfsizeof(const json_object* component, const json_object* type
 static int bvri_gltfpushbackattribute(struct bvri_gltfobject* object, json_object* target, uint32_t offset, const uint32 stride, const uint32 tbuffer);
 static void bvri_gltfhandletransform(struct bvri_gltfobject* object, const json_object* node, bvr_vertex_group_t* group);
 static void bvri_gltfhandlescale(struct bvri_gltfobject* object, json_object* target);
+static void bvri_gltfhandlebounds(struct bvri_gltfobject* object, json_object* target, struct bvr_aabb_s* bounds);
 
 static int bvri_is_gltf(FILE* file){
     fseek(file, 0, SEEK_SET);
@@ -601,8 +617,8 @@ static int bvri_load_gltf(bvr_mesh_t* mesh, FILE* file){
         BVR_MESH_ATTRIB_V3UV2N3
     );
 
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
 
     // extract binaries
     {
@@ -616,14 +632,17 @@ static int bvri_load_gltf(bvr_mesh_t* mesh, FILE* file){
 
     object.elements.count = 0;
 
-    bvr_create_pool(&mesh->vertex_groups, sizeof(bvr_vertex_group_t), json_object_array_length(object.json_nodes));
+    bvr_create_slotmap(&mesh->vertex_groups, sizeof(bvr_vertex_group_t), json_object_array_length(object.json_nodes));
 
     // read ressources
     for (size_t i = 0; i < json_object_array_length(object.json_nodes); i++)
     {
-        bvr_vertex_group_t* group = bvr_pool_alloc(&mesh->vertex_groups);
+        bvr_vertex_group_t* group = bvr_slotmap_alloc(&mesh->vertex_groups, NULL);
+        struct bvr_aabb_s node_bounds;
 
         object.scale = 1.0f;
+        BVR_SCALE_VEC3(node_bounds.min, INFINITY);
+        BVR_SCALE_VEC3(node_bounds.max, -INFINITY);
 
         json_node = json_object_array_get_idx(object.json_nodes, i);
         json_mesh = json_object_array_get_idx(object.json_meshes, json_object_get_int(json_object_object_get(json_node, "mesh")));
@@ -651,6 +670,7 @@ static int bvri_load_gltf(bvr_mesh_t* mesh, FILE* file){
             if(!json_object_is_type(json_position, json_type_null)){
                 bvri_gltfpushbackattribute(&object, json_position, 0, 8, GL_ARRAY_BUFFER);
                 bvri_gltfhandlescale(&object, json_position);
+                bvri_gltfhandlebounds(&object, json_position, &node_bounds);
             }
             
             // TEXTURE COORDS
@@ -673,12 +693,19 @@ static int bvri_load_gltf(bvr_mesh_t* mesh, FILE* file){
         
         bvri_gltfhandletransform(&object, json_node, group);
 
+        // node's bounds are moved into mesh's space
+        if(node_bounds.min[0] <= node_bounds.max[0]){
+            bvr_aabb_transform(&node_bounds, &node_bounds, group->matrix);
+            bvr_aabb_extend(&mesh->bounds, node_bounds.min);
+            bvr_aabb_extend(&mesh->bounds, node_bounds.max);
+        }
+
         group->element_offset = object.elements.count;
         object.elements.count += group->element_count;
     }
     
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     // free
     //TODO: detected a memory leak sometimes when freeing json's root
@@ -865,6 +892,32 @@ static void bvri_gltfhandlescale(struct bvri_gltfobject* object, json_object* ta
     object->scale = MAX(scale, 1.0f);
 }
 
+/*
+    Extend `bounds` with the min and max values of a position accessor.
+*/
+static void bvri_gltfhandlebounds(struct bvri_gltfobject* object, json_object* target, struct bvr_aabb_s* bounds){
+    json_object* json_accessor = json_object_array_get_idx(object->json_accessors, json_object_get_int(target));
+    BVR_ASSERT(json_accessor);
+
+    json_object* json_min = json_object_object_get(json_accessor, "min");
+    json_object* json_max = json_object_object_get(json_accessor, "max");
+
+    // min and max are required for positions, but some exporters skip them
+    if(json_object_get_type(json_min) != json_type_array || json_object_get_type(json_max) != json_type_array){
+        return;
+    }
+
+    vec3 min, max;
+    for (int i = 0; i < 3; i++)
+    {
+        min[i] = json_object_get_double(json_object_array_get_idx(json_min, i));
+        max[i] = json_object_get_double(json_object_array_get_idx(json_max, i));
+    }
+
+    bvr_aabb_extend(bounds, min);
+    bvr_aabb_extend(bounds, max);
+}
+
 #endif
 
 #ifndef BVR_NO_FBX
@@ -1180,12 +1233,9 @@ int bvr_create_meshf(bvr_mesh_t* mesh, FILE* file, bvr_mesh_array_attrib_t attri
     mesh->attrib_count = 0;
     mesh->stride = 0;
     mesh->attrib = attrib;
+    bvri_clear_mesh_bounds(mesh);
     
-    mesh->vertex_groups.data = NULL;
-    mesh->vertex_groups.avail = NULL;
-    mesh->vertex_groups.next_block = NULL;
-    mesh->vertex_groups.count = 0;
-    mesh->vertex_groups.elemsize = sizeof(bvr_vertex_group_t);
+    bvr_create_slotmap(&mesh->vertex_groups, sizeof(bvr_vertex_group_t), 0);
 
 #ifndef BVR_NO_GLTF
     if(bvri_is_gltf(file)){
@@ -1228,8 +1278,9 @@ int bvr_create_meshv(bvr_mesh_t* mesh, bvr_mesh_buffer_t* vertices, bvr_mesh_buf
     mesh->attrib_count = 0;
     mesh->stride = 0;
     mesh->attrib = attrib;
+    bvri_clear_mesh_bounds(mesh);
 
-    bvr_create_pool(&mesh->vertex_groups, sizeof(bvr_vertex_group_t), 1);
+    bvr_create_slotmap(&mesh->vertex_groups, sizeof(bvr_vertex_group_t), 1);
 
     status = bvri_create_mesh_buffers(mesh, 
         vertices->count * bvr_sizeof(vertices->type),
@@ -1242,7 +1293,7 @@ int bvr_create_meshv(bvr_mesh_t* mesh, bvr_mesh_buffer_t* vertices, bvr_mesh_buf
         return BVR_FALSE;
     }
 
-    bvr_vertex_group_t* group = bvr_pool_alloc(&mesh->vertex_groups);
+    bvr_vertex_group_t* group = bvr_slotmap_alloc(&mesh->vertex_groups, NULL);
     group->name.length = 0;
     group->name.string = NULL;
     group->element_offset = 0;
@@ -1251,8 +1302,8 @@ int bvr_create_meshv(bvr_mesh_t* mesh, bvr_mesh_buffer_t* vertices, bvr_mesh_buf
     BVR_IDENTITY_MAT4(group->matrix);
     
     // copy vertex values over buffers
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
 
     glBufferSubData(GL_ARRAY_BUFFER, 0, vertices->count * bvr_sizeof(vertices->type), vertices->data);
 
@@ -1260,8 +1311,21 @@ int bvr_create_meshv(bvr_mesh_t* mesh, bvr_mesh_buffer_t* vertices, bvr_mesh_buf
         glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, elements->count * bvr_sizeof(elements->type), elements->data);
     }
     
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // compute local bounds, packed vertices (landscapes) stay unbounded
+    if(vertices->type == BVR_FLOAT && attrib != BVR_MESH_ATTRIB_SINGLE){
+        const float* data = (const float*)vertices->data;
+        const int is_3d = attrib == BVR_MESH_ATTRIB_V3 || attrib == BVR_MESH_ATTRIB_V3UV2 || attrib == BVR_MESH_ATTRIB_V3UV2N3;
+
+        // attrib is the number of floats per vertex
+        for (uint64 i = 0; i + attrib <= vertices->count; i += attrib)
+        {
+            vec3 point = {data[i + 0], data[i + 1], is_3d ? data[i + 2] : 0.0f};
+            bvr_aabb_extend(&mesh->bounds, point);
+        }
+    }
 
     return BVR_TRUE;
 }
@@ -1281,18 +1345,18 @@ static int bvri_create_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint
 
     // create vertex array 
     glGenVertexArrays(1, &mesh->array_buffer);
-    glBindVertexArray(mesh->array_buffer);
+    bvr_gl_bind_vertex_array(mesh->array_buffer);
 
     // create vertex and element buffers
     glGenBuffers(1, &mesh->vertex_buffer);
     glGenBuffers(1, &mesh->element_buffer);
 
     // allocate the whole buffers
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vertex_buffer);
     glBufferData(GL_ARRAY_BUFFER, vertices_size, NULL, GL_STATIC_DRAW);
 
     if(element_size){
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
+        bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->element_buffer);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, element_size, NULL, GL_STATIC_DRAW);
     }
     
@@ -1386,13 +1450,11 @@ static int bvri_create_mesh_buffers(bvr_mesh_t* mesh, uint64 vertices_size, uint
         return BVR_FALSE;
     }
 
-    for (uint64 i = 0; i < mesh->attrib_count; i++){ 
-        glDisableVertexAttribArray(i); 
-    }
+    // attributes stay enabled, they belong to the vertex array
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    bvr_gl_bind_vertex_array(0);
 
     return BVR_TRUE;
 }
@@ -1535,12 +1597,16 @@ void bvr_destroy_mesh(bvr_mesh_t* mesh){
     BVR_ASSERT(mesh);
 
     bvr_vertex_group_t group;
-    BVR_POOL_FOR_EACH(group, mesh->vertex_groups){
+    BVR_SLOTMAP_FOR_EACH(group, mesh->vertex_groups){
         //TODO: find why this fucking vertex group mess up string's pointer
         //bvr_destroy_string(&group.name);
     }
 
-    //free(mesh->vertex_groups.data);
+    bvr_destroy_slotmap(&mesh->vertex_groups);
+
+    bvr_gl_state_forget(mesh->array_buffer);
+    bvr_gl_state_forget(mesh->vertex_buffer);
+    bvr_gl_state_forget(mesh->element_buffer);
 
     glDeleteVertexArrays(1, &mesh->array_buffer);
     glDeleteBuffers(1, &mesh->vertex_buffer);
@@ -0,0 +1,173 @@
+#include <BVR/messages.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#define BVRI_MESSAGE_TAG(head) ((head) >> 32)
+#define BVRI_MESSAGE_INDEX(head) ((uint32)(head))
+#define BVRI_MESSAGE_HEAD(tag, index) (((uint64)(tag) << 32) | (uint64)(index))
+
+static bvr_message_t* bvri_message_at(bvr_message_queue_t* queue, const uint32 index){
+    return &queue->chunks[index / BVR_MESSAGE_CHUNK_SIZE][index % BVR_MESSAGE_CHUNK_SIZE];
+}
+
+/*
+    Push a linked list of messages [first, last] on the free stack.
+*/
+static void bvri_push_free_messages(bvr_message_queue_t* queue, bvr_message_t* first, bvr_message_t* last){
+    uint64 head = __atomic_load_n(&queue->free, __ATOMIC_ACQUIRE);
+    uint64 next;
+
+    do {
+        __atomic_store_n(&last->next, BVRI_MESSAGE_INDEX(head), __ATOMIC_RELAXED);
+        next = BVRI_MESSAGE_HEAD(BVRI_MESSAGE_TAG(head) + 1, first->index);
+    } while (!__atomic_compare_exchange_n(&queue->free, &head, next, BVR_TRUE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+/*
+    Add a new chunk of free messages.
+    Returns BVR_FALSE if the pool reached BVR_MESSAGE_MAX_CHUNKS.
+*/
+static int bvri_grow_message_pool(bvr_message_queue_t* queue){
+    while (__atomic_exchange_n(&queue->growing, 1, __ATOMIC_ACQUIRE))
+    {
+        sched_yield();
+    }
+
+    // another thread might have grown the pool
+    if(BVRI_MESSAGE_INDEX(__atomic_load_n(&queue->free, __ATOMIC_ACQUIRE)) != BVR_INVALID_INDEX){
+        __atomic_store_n(&queue->growing, 0, __ATOMIC_RELEASE);
+        return BVR_TRUE;
+    }
+
+    const uint32 chunk_index = queue->chunk_count;
+    bvr_message_t* chunk = NULL;
+
+    if(chunk_index < BVR_MESSAGE_MAX_CHUNKS){
+        chunk = malloc(BVR_MESSAGE_CHUNK_SIZE * sizeof(bvr_message_t));
+    }
+
+    if(!chunk){
+        __atomic_store_n(&queue->growing, 0, __ATOMIC_RELEASE);
+
+        BVR_PRINT("message pool is full!");
+        return BVR_FALSE;
+    }
+
+    for (uint32 i = 0; i < BVR_MESSAGE_CHUNK_SIZE; i++)
+    {
+        chunk[i].index = chunk_index * BVR_MESSAGE_CHUNK_SIZE + i;
+        chunk[i].next = chunk[i].index + 1;
+    }
+
+    // chunk must be visible before its messages are
+    queue->chunks[chunk_index] = chunk;
+    __atomic_store_n(&queue->chunk_count, chunk_index + 1, __ATOMIC_RELEASE);
+
+    bvri_push_free_messages(queue, &chunk[0], &chunk[BVR_MESSAGE_CHUNK_SIZE - 1]);
+
+    __atomic_store_n(&queue->growing, 0, __ATOMIC_RELEASE);
+    return BVR_TRUE;
+}
+
+void bvr_create_message_queue(bvr_message_queue_t* queue){
+    BVR_ASSERT(queue);
+
+    memset(queue, 0, sizeof(bvr_message_queue_t));
+    queue->free = BVRI_MESSAGE_HEAD(0, BVR_INVALID_INDEX);
+    queue->head = BVR_INVALID_INDEX;
+}
+
+bvr_message_t* bvr_message_alloc(bvr_message_queue_t* queue){
+    BVR_ASSERT(queue);
+
+    uint64 head = __atomic_load_n(&queue->free, __ATOMIC_ACQUIRE);
+    while (BVR_TRUE)
+    {
+        const uint32 index = BVRI_MESSAGE_INDEX(head);
+
+        if(index == BVR_INVALID_INDEX){
+            if(!bvri_grow_message_pool(queue)){
+                return NULL;
+            }
+
+            head = __atomic_load_n(&queue->free, __ATOMIC_ACQUIRE);
+            continue;
+        }
+
+        // next might be stale if another thread took this message, the tag makes the exchange fail
+        bvr_message_t* message = bvri_message_at(queue, index);
+        const uint64 next = BVRI_MESSAGE_HEAD(BVRI_MESSAGE_TAG(head) + 1, __atomic_load_n(&message->next, __ATOMIC_RELAXED));
+
+        if(__atomic_compare_exchange_n(&queue->free, &head, next, BVR_TRUE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+            return message;
+        }
+    }
+}
+
+void bvr_message_free(bvr_message_queue_t* queue, bvr_message_t* message){
+    BVR_ASSERT(queue);
+    BVR_ASSERT(message);
+
+    bvri_push_free_messages(queue, message, message);
+}
+
+void bvr_message_post(bvr_message_queue_t* queue, bvr_message_t* message){
+    BVR_ASSERT(queue);
+    BVR_ASSERT(message);
+
+    uint32 head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+
+    do {
+        __atomic_store_n(&message->next, head, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&queue->head, &head, message->index, BVR_TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+bvr_message_t* bvr_message_take(bvr_message_queue_t* queue){
+    BVR_ASSERT(queue);
+
+    uint32 index = __atomic_exchange_n(&queue->head, BVR_INVALID_INDEX, __ATOMIC_ACQUIRE);
+    uint32 previous = BVR_INVALID_INDEX;
+
+    // messages are stacked, reverse them to get posting order
+    while (index != BVR_INVALID_INDEX)
+    {
+        bvr_message_t* message = bvri_message_at(queue, index);
+        const uint32 next = message->next;
+
+        message->next = previous;
+        previous = index;
+        index = next;
+    }
+
+    if(previous == BVR_INVALID_INDEX){
+        return NULL;
+    }
+
+    return bvri_message_at(queue, previous);
+}
+
+bvr_message_t* bvr_message_next(bvr_message_queue_t* queue, bvr_message_t* message){
+    BVR_ASSERT(queue);
+    BVR_ASSERT(message);
+
+    if(message->next == BVR_INVALID_INDEX){
+        return NULL;
+    }
+
+    return bvri_message_at(queue, message->next);
+}
+
+void bvr_destroy_message_queue(bvr_message_queue_t* queue){
+    BVR_ASSERT(queue);
+
+    for (uint32 i = 0; i < queue->chunk_count; i++)
+    {
+        free(queue->chunks[i]);
+    }
+
+    memset(queue, 0, sizeof(bvr_message_queue_t));
+    queue->free = BVRI_MESSAGE_HEAD(0, BVR_INVALID_INDEX);
+    queue->head = BVR_INVALID_INDEX;
+}
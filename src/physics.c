@@ -25,22 +25,24 @@ void bvr_body_add_force(struct bvr_body_s* body, float x, float y, float z){
     }
 }
 
-void bvr_body_apply_motion(struct bvr_body_s* body, struct bvr_transform_s* transform){
+int bvr_body_apply_motion(struct bvr_body_s* body, struct bvr_transform_s* transform, const float delta){
     BVR_ASSERT(body);
     BVR_ASSERT(transform);
 
+    int moved = BVR_FALSE;
+
     if(body->acceleration){
         vec3 translate;
         BVR_IDENTITY_VEC3(translate);
     
         vec3_add(translate, translate, body->direction);
-        vec3_scale(translate, translate, body->acceleration);
+        vec3_scale(translate, translate, body->acceleration * delta);
         vec3_add(transform->position, transform->position, translate);
     
+        moved = translate[0] != 0.0f || translate[1] != 0.0f || translate[2] != 0.0f;
     }
 
-    body->acceleration = 0.0f;
-    BVR_IDENTITY_VEC3(body->direction);
+    return moved;
 }
 
 /*
@@ -59,6 +61,7 @@ void bvr_create_collider(bvr_collider_t* collider, float* vertices, uint64 count
     collider->is_inverted = false;
     collider->is_enabled = true;
     collider->transform = NULL;
+    collider->actor = NULL;
     
     BVR_IDENTITY_VEC3(collider->body.direction);
 }
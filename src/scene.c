@@ -4,19 +4,20 @@
 #include <BVR/lights.h>
 #include <BVR/assets.book.h>
 
+#include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include <memory.h>
 
 #include <malloc.h>
 
-#define BVR_SCENE_PADDING (BVR_MAX_SIZEOF(bvr_layer_actor_t, \
-    BVR_MAX_SIZEOF(bvr_dynamic_actor_t, BVR_MAX_SIZEOF(bvr_texture_actor_t, \
-    bvr_landscape_actor_t))) + 2)
-
 static bvr_book_t *__s_book_instance = NULL;
 bvr_book_t *bvr_get_instance() { return __s_book_instance; }
 
 static size_t bvri_actor_size(bvr_actor_type_t type);
+static size_t bvri_actor_alignment(bvr_actor_type_t type);
+static void bvri_settle_transforms(struct bvr_transform_stream_s *transforms);
+static void bvri_interpolate_transforms(struct bvr_transform_stream_s *transforms, const float alpha);
 
 int bvr_create_book(bvr_book_t *book)
 {
@@ -35,6 +36,10 @@ int bvr_create_book(bvr_book_t *book)
     book->timer.prev_time = 0.0f;
     book->timer.current_time = 0.0f;
     book->timer.average_render_time = 0.0f;
+    book->timer.accumulator = 0.0f;
+    book->timer.alpha = 1.0f;
+    book->timer.ticks = 0;
+    bvr_set_tick_rate(book, BVR_TICK_RATE);
 
     book->pipeline.rendering_pass.blending = BVR_BLEND_FUNC_ALPHA_ONE_MINUS;
     book->pipeline.rendering_pass.depth = BVR_DEPTH_FUNC_LESS;
@@ -50,7 +55,16 @@ int bvr_create_book(bvr_book_t *book)
     book->pipeline.state.command = NULL;
 
     book->pipeline.command_count = 0;
-    memset(&book->pipeline.commands, 0, sizeof(book->pipeline.commands));
+    book->pipeline.command_peak = 0;
+    book->pipeline.command_capacity = BVR_MAX_DRAW_COMMAND;
+    book->pipeline.commands = calloc(BVR_MAX_DRAW_COMMAND, sizeof(struct bvr_draw_command_s));
+    BVR_ASSERT(book->pipeline.commands);
+
+    book->pipeline.instances.buffer = 0;
+    book->pipeline.instances.count = 0;
+
+    memset(&book->pipeline.objects, 0, sizeof(book->pipeline.objects));
+    book->pipeline.objects.bound = BVR_INVALID_INDEX;
 
     book->predefs.is_available = false;
     book->page.is_available = false;
@@ -61,11 +75,32 @@ int bvr_create_book(bvr_book_t *book)
     book->page.events.update = NULL;
     book->page.events.destroy = NULL;
 
+    bvr_create_frame_arena(&book->frame_memory, BVR_FRAME_MEMORY_SIZE);
+
+    // streams allocate their first page on the first write
     bvr_create_memstream(&book->asset_stream, 0);
-    bvr_create_memstream(
-        &book->garbage_stream,
-        (BVR_MAX_SCENE_ACTOR_COUNT + BVR_MAX_SCENE_LIGHT_COUNT) * BVR_SCENE_PADDING
-    );
+    bvr_create_memstream(&book->garbage_stream, 0);
+    bvr_create_hashmap(&book->asset_index, 0);
+    bvr_create_hashmap(&book->asset_uuid_index, 0);
+
+    bvr_create_job_system(&book->jobs, BVR_JOB_THREAD_COUNT);
+
+    // frame arenas are not thread safe, each worker gets its own
+    book->worker_memory = NULL;
+    if (book->jobs.worker_count > 1)
+    {
+        book->worker_memory = calloc(book->jobs.worker_count - 1, sizeof(bvr_frame_arena_t));
+        BVR_ASSERT(book->worker_memory);
+
+        for (uint32 i = 0; i < book->jobs.worker_count - 1; i++)
+        {
+            bvr_create_frame_arena(&book->worker_memory[i], BVR_FRAME_MEMORY_SIZE);
+        }
+    }
+
+    book->pipeline.lists = NULL;
+    book->pipeline.list_count = 0;
+    book->pipeline.recording = false;
 
     return BVR_TRUE;
 }
@@ -73,20 +108,18 @@ int bvr_create_book(bvr_book_t *book)
 void bvr_create_book_memories(bvr_book_t* book, const uint64 asset_size, const uint64 garbage_size){
     BVR_ASSERT(book);
 
-    if(!book->asset_stream.data && asset_size){
+    // streams grow on demand, sizes are only first page's sizes
+    if(!book->asset_stream.pages && asset_size){
         bvr_create_memstream(&book->asset_stream, asset_size);        
     }
     else {
         BVR_PRINT("could not create a new asset stream!");
     }
 
-    if(garbage_size){
+    if(garbage_size && !book->garbage_stream.length){
         bvr_destroy_memstream(&book->garbage_stream);
         bvr_create_memstream(&book->garbage_stream, garbage_size);
     }
-    else {
-        BVR_PRINT("invalid garbage stream size!");
-    }
 
     if(!book->predefs.is_available){
         bvr_create_predefs(&book->predefs);
@@ -100,6 +133,16 @@ void bvr_new_frame(bvr_book_t *book)
     book->timer.current_time = bvr_frames();
     book->timer.delta_timef = (book->timer.current_time - book->timer.prev_time) / 1000.0f;
 
+    // release memory from two frames ago
+    bvr_frame_arena_swap(&book->frame_memory);
+    for (uint32 i = 0; book->worker_memory && i < book->jobs.worker_count - 1; i++)
+    {
+        bvr_frame_arena_swap(&book->worker_memory[i]);
+    }
+
+    // move to the next object buffer region
+    bvr_pipeline_new_frame(&book->pipeline);
+
     // reset opengl states
     bvr_framebuffer_enable(&book->window.framebuffer);
     bvr_framebuffer_clear(&book->window.framebuffer, book->pipeline.clear_color);
@@ -123,24 +166,19 @@ void bvr_new_frame(bvr_book_t *book)
     }
 }
 
-void bvr_update(bvr_book_t *book)
+/*
+    Run a single simulation step of `delta` seconds.
+*/
+static void bvri_tick(bvr_book_t *book, const float delta)
 {
     bvr_collider_t *collider = NULL;
     bvr_collider_t *other = NULL;
 
-    if (!bvr_is_active(book))
-    {
-        return;
-    }
+    bvr_update_actors(book);
+    bvr_dispatch_messages(&book->page);
 
-    BVR_POOL_FOR_EACH(collider, book->page.colliders)
+    BVR_SLOTMAP_FOR_EACH(collider, book->page.colliders)
     {
-
-        if (!collider)
-        {
-            break;
-        }
-
         // update collider infos
         if (collider->shape == BVR_COLLIDER_BOX)
         {
@@ -160,13 +198,8 @@ void bvr_update(bvr_book_t *book)
 
             struct bvr_collision_result_s result;
 
-            BVR_POOL_FOR_EACH(other, book->page.colliders)
+            BVR_SLOTMAP_FOR_EACH(other, book->page.colliders)
             {
-                if (!other)
-                {
-                    break;
-                }
-
                 bvr_compare_colliders(collider, other, &result);
 
                 if (result.collide == 1)
@@ -179,30 +212,348 @@ void bvr_update(bvr_book_t *book)
             }
         }
 
-        bvr_body_apply_motion(&collider->body, collider->transform);
+        if (bvr_body_apply_motion(&collider->body, collider->transform, delta) && collider->actor)
+        {
+            bvr_set_actor_dirty(collider->actor);
+        }
+    }
+
+    bvr_page_update_transforms(&book->page);
+}
+
+void bvr_update(bvr_book_t *book)
+{
+    struct bvr_chrono_s *timer = &book->timer;
+    bvr_collider_t *collider = NULL;
+
+    if (!bvr_is_active(book))
+    {
+        return;
+    }
+
+    timer->accumulator += timer->delta_timef;
+    timer->ticks = 0;
+
+    while (timer->accumulator >= timer->fixed_delta_timef && timer->ticks < BVR_MAX_TICKS_PER_FRAME)
+    {
+        // matrices of the last tick become the previous state
+        bvri_settle_transforms(&book->page.transforms);
+
+        bvri_tick(book, timer->fixed_delta_timef);
+
+        timer->accumulator -= timer->fixed_delta_timef;
+        timer->ticks++;
+    }
+
+    // simulation cannot keep up, drop the late time instead of spiraling
+    if (timer->accumulator >= timer->fixed_delta_timef)
+    {
+        timer->accumulator = fmodf(timer->accumulator, timer->fixed_delta_timef);
+    }
+
+    timer->alpha = timer->accumulator / timer->fixed_delta_timef;
+
+    // forces are applied during each tick of the frame
+    if (timer->ticks)
+    {
+        BVR_SLOTMAP_FOR_EACH(collider, book->page.colliders)
+        {
+            bvr_body_clear_forces(&collider->body);
+        }
+    }
+}
+
+void bvr_set_tick_rate(bvr_book_t *book, const float rate)
+{
+    BVR_ASSERT(book);
+    BVR_ASSERT(rate > 0.0f);
+
+    book->timer.fixed_delta_timef = 1.0f / rate;
+}
+
+/*
+    Camera's view used to cull actors.
+    Orthographic cameras test boxes against their view's box, perspective cameras use their frustum.
+*/
+struct bvri_cull_view_s
+{
+    uint32 mode;
+    struct bvr_aabb_s bounds;
+    struct bvr_frustum_s frustum;
+};
+
+/*
+    Returns BVR_TRUE if actor's mesh bounds overlap camera's view.
+*/
+static int bvri_is_actor_visible(const struct bvri_cull_view_s *view, struct bvr_actor_s *actor)
+{
+    // each drawable actor starts with a mesh
+    bvr_mesh_t *mesh = &((bvr_static_actor_t *)actor)->mesh;
+
+    // unbounded meshes (landscapes) are always drawn
+    if (!bvr_mesh_has_bounds(mesh))
+    {
+        return BVR_TRUE;
+    }
+
+    struct bvr_aabb_s bounds;
+    bvr_aabb_transform(&bounds, &mesh->bounds, bvr_get_actor_render_matrix(actor));
+
+    if (view->mode == BVR_CAMERA_ORTHOGRAPHIC)
+    {
+        return bvr_aabb_overlap(&view->bounds, &bounds);
+    }
+
+    return bvr_frustum_contains_aabb(&view->frustum, &bounds);
+}
+
+/*
+    Commands recorded by a single `bvr_draw_page` batch
+*/
+struct bvri_draw_segment_s
+{
+    struct bvr_command_list_s *list;
+    uint32 offset, count;
+
+    // first actor of the next batch
+    uint32 end;
+};
+
+struct bvri_draw_job_s
+{
+    const struct bvri_cull_view_s *view;
+    struct bvr_actor_s **actors;
+    struct bvri_draw_segment_s *segments;
+    bvr_pipeline_t *pipeline;
+};
+
+/*
+    Cull and record actors [begin, end[ inside worker's command list.
+*/
+static void bvri_record_actors(void *data, uint32 begin, uint32 end)
+{
+    struct bvri_draw_job_s *job = (struct bvri_draw_job_s *)data;
+    struct bvr_command_list_s *list = bvr_pipeline_command_list(job->pipeline);
+    struct bvri_draw_segment_s *segment = &job->segments[begin];
+
+    segment->list = list;
+    segment->offset = list ? list->count : 0;
+    segment->end = end;
+
+    uint32 visible = 0, culled = 0;
+    for (uint32 i = begin; i < end; i++)
+    {
+        if (!bvri_is_actor_visible(job->view, job->actors[i]))
+        {
+            culled++;
+            continue;
+        }
+
+        bvr_submit_actor(job->actors[i], BVR_DRAWMODE_TRIANGLES);
+        visible++;
+    }
+
+    segment->count = list ? list->count - segment->offset : 0;
+
+    __atomic_fetch_add(&job->pipeline->stats.visible, visible, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->pipeline->stats.culled, culled, __ATOMIC_RELAXED);
+}
+
+void bvr_draw_page(bvr_book_t *book)
+{
+    BVR_ASSERT(book);
+
+    bvr_page_t *page = &book->page;
+    struct bvr_draw_stats_s *stats = &book->pipeline.stats;
+    stats->visible = 0;
+    stats->culled = 0;
+    stats->submitted = 0;
+    stats->instanced_draws = 0;
+    stats->instanced_commands = 0;
+    stats->objects = 0;
+    stats->sprites = 0;
+    stats->sprite_batches = 0;
+    stats->streamed_bytes = 0;
+
+    if (!page->is_available)
+    {
+        return;
+    }
+
+    struct bvr_actor_s *actor = NULL;
+
+    // actors might have moved since the last tick
+    bvr_page_update_transforms(page);
+    bvri_interpolate_transforms(&page->transforms, book->timer.alpha);
+
+    struct bvri_cull_view_s view;
+    view.mode = page->camera.mode;
+    if (view.mode == BVR_CAMERA_ORTHOGRAPHIC)
+    {
+        bvr_camera_view_bounds(&page->camera, &view.bounds);
+    }
+    else
+    {
+        bvr_camera_frustum(&page->camera, &view.frustum);
+    }
+
+    struct bvr_actor_s **actors = bvr_frame_alloc(page->actors.count * sizeof(struct bvr_actor_s *));
+    struct bvri_draw_segment_s *segments = bvr_frame_alloc(page->actors.count * sizeof(struct bvri_draw_segment_s));
+    if (!actors || !segments)
+    {
+        BVR_PRINT("failed to allocate draw list!");
+        return;
+    }
+
+    // layer actors render their composite while being submitted, they stay on this thread.
+    // they are packed at the end of the list.
+    uint32 count = 0, layer_count = 0;
+    BVR_SLOTMAP_FOR_EACH(actor, page->actors)
+    {
+        if (!actor->active || actor->type == BVR_EMPTY_ACTOR || bvr_is_actor_null(actor))
+        {
+            continue;
+        }
+
+        if (actor->type == BVR_LAYER_ACTOR)
+        {
+            actors[page->actors.count - ++layer_count] = actor;
+            continue;
+        }
+
+        actors[count++] = actor;
+    }
+
+    // submit visible actors, commands are sorted by key when the pipeline is flushed
+    const uint32 command_count = book->pipeline.command_count;
+
+    struct bvri_draw_job_s job;
+    job.view = &view;
+    job.actors = actors;
+    job.segments = segments;
+    job.pipeline = &book->pipeline;
+
+    if (bvr_pipeline_begin_recording(&book->pipeline, book->jobs.worker_count))
+    {
+        bvr_parallel_for(&book->jobs, count, BVR_DRAW_BATCH_SIZE, bvri_record_actors, &job);
+
+        // merge batches in actor order, so commands match a serial traversal
+        for (uint32 i = 0; i < count; i = segments[i].end)
+        {
+            if (segments[i].list)
+            {
+                bvr_pipeline_merge_commands(&book->pipeline, segments[i].list, segments[i].offset, segments[i].count);
+            }
+        }
+
+        bvr_pipeline_end_recording(&book->pipeline);
+    }
+    else
+    {
+        bvri_record_actors(&job, 0, count);
+    }
+
+    for (uint32 i = 0; i < layer_count; i++)
+    {
+        actor = actors[page->actors.count - 1 - i];
+
+        if (!bvri_is_actor_visible(&view, actor))
+        {
+            stats->culled++;
+            continue;
+        }
+
+        bvr_submit_actor(actor, BVR_DRAWMODE_TRIANGLES);
+        stats->visible++;
+    }
+
+    stats->submitted = book->pipeline.command_count - command_count;
+}
+
+/*
+    Get calling thread's frame arena.
+*/
+static bvr_arena_t *bvri_frame_arena(void)
+{
+    const uint32 worker = bvr_job_worker_index();
+
+    if (worker != BVR_INVALID_INDEX && worker > 0 && __s_book_instance->worker_memory)
+    {
+        return bvr_frame_arena_get(&__s_book_instance->worker_memory[worker - 1]);
+    }
+
+    return bvr_frame_arena_get(&__s_book_instance->frame_memory);
+}
+
+void *bvr_frame_alloc(const uint64 size)
+{
+    BVR_ASSERT(__s_book_instance);
+
+    return bvr_arena_alloc(bvri_frame_arena(), size, BVR_ARENA_ALIGNMENT);
+}
+
+char *bvr_frame_format(const char *format, ...)
+{
+    BVR_ASSERT(format);
+
+    va_list arg_list;
+    int length;
+    char *string;
+
+    va_start(arg_list, format);
+    length = vsnprintf(NULL, 0, format, arg_list);
+    va_end(arg_list);
+
+    if (length < 0)
+    {
+        return NULL;
     }
+
+    string = bvr_arena_alloc(bvri_frame_arena(), length + 1, 1);
+
+    va_start(arg_list, format);
+    vsnprintf(string, length + 1, format, arg_list);
+    va_end(arg_list);
+
+    return string;
 }
 
 void bvr_flush(bvr_book_t *book)
 {
-    // WARN: i did that because it work but idk 
-    // when there is only one element to draw, things get overwritten :<
-    //if(book->pipeline.command_count > 1){
-    //    // sort draw command by using their 'order'
-    //    qsort(book->pipeline.commands,
-    //        book->pipeline.command_count,
-    //        sizeof(struct bvr_draw_command_s),
-    //        bvr_pipeline_compare_commands
-    //    );
-    //}
+    bvr_pipeline_t *pipeline = &book->pipeline;
 
-    // draw each command
-    for (uint64 i = 0; i < book->pipeline.command_count; i++)
+    if (!pipeline->command_count)
     {
-        bvr_pipeline_draw_cmd(&book->pipeline.commands[i]);
+        return;
     }
 
-    book->pipeline.command_count = 0;
+    // per-object constants are written at once, draws only bind their range
+    bvr_pipeline_upload_objects(pipeline);
+
+    // draw commands by key, opaque commands first
+    uint32 *order = bvr_frame_alloc(pipeline->command_count * sizeof(uint32));
+    if (!order)
+    {
+        BVR_PRINT("failed to allocate draw order!");
+
+        for (uint32 i = 0; i < pipeline->command_count; i++)
+        {
+            bvr_pipeline_draw_cmd(&pipeline->commands[i]);
+        }
+
+        pipeline->command_count = 0;
+        return;
+    }
+
+    bvr_pipeline_sort_commands(pipeline, order);
+
+    // runs of instanced commands are drawn at once
+    for (uint32 i = 0; i < pipeline->command_count;)
+    {
+        i += bvr_pipeline_draw_run(pipeline, order + i, pipeline->command_count - i);
+    }
+
+    pipeline->command_count = 0;
 }
 
 void bvr_render(bvr_book_t *book)
@@ -227,7 +578,7 @@ void bvr_render(bvr_book_t *book)
 
 #ifndef BVR_NO_FPS_CAP
     // wait for next frame.
-    double delay = BVR_TARGET_FRAMERATE * 0.25 - (bvr_frames() - book->timer.current_time);
+    double delay = 1000.0 / BVR_TARGET_FRAMERATE - (bvr_frames() - book->timer.current_time);
     if (delay > 0)
     {
         bvr_delay(delay);
@@ -245,12 +596,18 @@ void bvr_render(bvr_book_t *book)
         book->timer.frame_timer = book->timer.delta_timef;
     }
 
+    book->pipeline.stats.avoided = bvr_gl_state_avoided_calls();
+
     // debug
     bvr_poll_errors();
 }
 
 void bvr_destroy_book(bvr_book_t *book)
 {
+    // GL objects must be deleted before the context
+    bvr_destroy_instance_buffer(&book->pipeline);
+    bvr_destroy_object_buffer(&book->pipeline);
+
     // try to destroy the window
     if (book->window.context)
     {
@@ -270,6 +627,26 @@ void bvr_destroy_book(bvr_book_t *book)
     bvr_destroy_predefs(&book->predefs);
     bvr_destroy_memstream(&book->asset_stream);
     bvr_destroy_memstream(&book->garbage_stream);
+    bvr_destroy_hashmap(&book->asset_index);
+    bvr_destroy_hashmap(&book->asset_uuid_index);
+
+    free(book->pipeline.commands);
+    book->pipeline.commands = NULL;
+    book->pipeline.command_capacity = 0;
+    bvr_destroy_command_lists(&book->pipeline);
+    bvr_destroy_frame_arena(&book->frame_memory);
+
+    for (uint32 i = 0; book->worker_memory && i < book->jobs.worker_count - 1; i++)
+    {
+        bvr_destroy_frame_arena(&book->worker_memory[i]);
+    }
+
+    free(book->worker_memory);
+    book->worker_memory = NULL;
+
+    bvr_destroy_job_system(&book->jobs);
+
+    bvr_destroy_string_table();
 }
 
 int bvr_create_page(bvr_page_t *page, const char *name)
@@ -293,12 +670,27 @@ int bvr_create_page(bvr_page_t *page, const char *name)
 
     bvr_create_string(&page->name, name);
 
-    bvr_create_pool(&page->actors, sizeof(struct bvr_actor_s *), BVR_MAX_SCENE_ACTOR_COUNT);
-    bvr_create_pool(&page->colliders, sizeof(bvr_collider_t *), BVR_COLLIDER_COLLECTION_SIZE);
-    bvr_create_pool(&page->lights, sizeof(struct bvr_light_s *), BVR_MAX_SCENE_LIGHT_COUNT);
+    memset(&page->heap, 0, sizeof(struct bvr_actor_heap_s));
+    memset(&page->index, 0, sizeof(struct bvr_actor_index_s));
+    memset(&page->transforms, 0, sizeof(struct bvr_transform_stream_s));
+
+    bvr_create_hashmap(&page->grid.cells, BVR_MAX_SCENE_ACTOR_COUNT);
+    page->grid.cell_size = BVR_SPATIAL_CELL_SIZE;
+
+    bvr_create_hashmap(&page->index.names, BVR_MAX_SCENE_ACTOR_COUNT);
+    bvr_create_hashmap(&page->index.uuids, BVR_MAX_SCENE_ACTOR_COUNT);
+    bvr_create_hashmap(&page->index.tags, 0);
+
+    bvr_create_message_queue(&page->mailbox.queue);
+    bvr_create_hashmap(&page->mailbox.channels, 0);
+    bvr_create_hashmap(&page->mailbox.subscriptions, 0);
+
+    bvr_create_slotmap(&page->actors, sizeof(struct bvr_actor_s *), BVR_MAX_SCENE_ACTOR_COUNT);
+    bvr_create_slotmap(&page->colliders, sizeof(bvr_collider_t *), BVR_COLLIDER_COLLECTION_SIZE);
+    bvr_create_slotmap(&page->lights, sizeof(struct bvr_light_s *), BVR_MAX_SCENE_LIGHT_COUNT);
 
     // create global lighting
-    bvr_global_illumination_t **gl = (bvr_global_illumination_t **)bvr_pool_alloc(&page->lights);
+    bvr_global_illumination_t **gl = (bvr_global_illumination_t **)bvr_slotmap_alloc(&page->lights, NULL);
     *gl = &page->global_illumination;
 
     page->is_available = true;
@@ -345,167 +737,1591 @@ void bvr_disable_page(bvr_page_t *page)
 #endif
 
     bvr_memstream_clear(&__s_book_instance->garbage_stream);
-    bvr_memstream_clear(&__s_book_instance->asset_stream);
+    bvr_clear_assets();
 
     bvr_destroy_page(&__s_book_instance->page);
 }
 
-struct bvr_actor_s *bvr_alloc_actor(bvr_page_t *page, bvr_actor_type_t type)
+/*
+    Transform's dirty flags.
+    LOCAL: actor's transform has been modified, WORLD: world matrix is queued for the current batch.
+*/
+#define BVRI_TRANSFORM_LOCAL 0x01
+#define BVRI_TRANSFORM_WORLD 0x02
+#define BVRI_TRANSFORM_DEFERRED 0x04
+
+static int bvri_reserve_transforms(struct bvr_transform_stream_s *transforms, const uint32 count)
 {
-    BVR_ASSERT(page);
+    if (count <= transforms->capacity)
+    {
+        return BVR_TRUE;
+    }
 
-    struct bvr_actor_s** pp_actor;
-    const size_t actor_byte_size = bvri_actor_size(type);
+    const uint32 capacity = MAX(count, MAX(transforms->capacity * 2, BVR_MAX_SCENE_ACTOR_COUNT));
 
-    // check if this actor can be added
-    if(actor_byte_size <= 0 || actor_byte_size >= BVR_SCENE_PADDING){
-        BVR_PRINT("failed to allocate a new actor :<");
-        return NULL;
-    }
+    vec3 *positions = realloc(transforms->positions, capacity * sizeof(vec3));
+    if (positions) transforms->positions = positions;
+    
+    vec3 *rotations = realloc(transforms->rotations, capacity * sizeof(vec3));
+    if (rotations) transforms->rotations = rotations;
 
-    // get actor's pool pointer
-    pp_actor = (struct bvr_actor_s **)bvr_pool_alloc(&page->actors);
+    vec3 *scales = realloc(transforms->scales, capacity * sizeof(vec3));
+    if (scales) transforms->scales = scales;
 
-    // define actor's pointer as current memory stream cursor
-    *pp_actor = (struct bvr_actor_s *)__s_book_instance->garbage_stream.cursor;
+    mat4x4 *locals = realloc(transforms->locals, capacity * sizeof(mat4x4));
+    if (locals) transforms->locals = locals;
 
-    // everything heaped is padded to a certain constant value
-    memset(*pp_actor, 0, BVR_SCENE_PADDING);
+    mat4x4 *matrices = realloc(transforms->matrices, capacity * sizeof(mat4x4));
+    if (matrices) transforms->matrices = matrices;
 
-    bvr_memstream_write(
-        &__s_book_instance->garbage_stream,
-        NULL,
-        BVR_SCENE_PADDING
-    );
+    mat4x4 *previous = realloc(transforms->previous, capacity * sizeof(mat4x4));
+    if (previous) transforms->previous = previous;
 
-    BVR_PRINTF("alloacted a new actor (%x) remains %i bytes", 
-        *pp_actor, __s_book_instance->garbage_stream.size - (size_t)(__s_book_instance->garbage_stream.cursor - (char*)__s_book_instance->garbage_stream.data)
-    );
+    mat4x4 *interpolated = realloc(transforms->interpolated, capacity * sizeof(mat4x4));
+    if (interpolated) transforms->interpolated = interpolated;
 
-    (*pp_actor)->type = type;
-    (*pp_actor)->flags = 0;
-    (*pp_actor)->order_in_layer = 0;
-    (*pp_actor)->active = true;
-    (*pp_actor)->callback = NULL;
+    uint32 *parents = realloc(transforms->parents, capacity * sizeof(uint32));
+    if (parents) transforms->parents = parents;
 
-    BVR_IDENTITY_VEC3((*pp_actor)->transform.position);
-    BVR_IDENTITY_VEC3((*pp_actor)->transform.rotation);
-    BVR_SCALE_VEC3((*pp_actor)->transform.scale, 1.0f);
-    BVR_IDENTITY_MAT4((*pp_actor)->transform.matrix);
+    uint16 *depths = realloc(transforms->depths, capacity * sizeof(uint16));
+    if (depths) transforms->depths = depths;
 
-    // types that have colliders
-    if(type == BVR_DYNAMIC_ACTOR || type == BVR_TEXTURE_ACTOR){
-        bvr_register_collider(page, &((bvr_dynamic_actor_t*)*pp_actor)->collider);
-    }   
+    uint64 *cells = realloc(transforms->cells, capacity * sizeof(uint64));
+    if (cells) transforms->cells = cells;
 
-    return *pp_actor;
-}
+    struct bvr_actor_s **actors = realloc(transforms->actors, capacity * sizeof(struct bvr_actor_s *));
+    if (actors) transforms->actors = actors;
 
-void bvr_free_actor(bvr_page_t* page, struct bvr_actor_s* actor){
-    BVR_ASSERT(page);
-    
-    if(actor){
-        bvr_destroy_actor(actor);
-        bvr_pool_remove(&page->actors, actor);
+    uint8 *dirty = realloc(transforms->dirty, capacity * sizeof(uint8));
+    if (dirty) transforms->dirty = dirty;
+
+    uint8 *moving = realloc(transforms->moving, capacity * sizeof(uint8));
+    if (moving) transforms->moving = moving;
+
+    // each transform is listed once
+    uint32 *moving_list = realloc(transforms->moving_list, capacity * sizeof(uint32));
+    if (moving_list) transforms->moving_list = moving_list;
 
-        __s_book_instance->garbage_stream.cursor = (char*)actor;
+    if (!positions || !rotations || !scales || !locals || !matrices || !previous || !interpolated || 
+        !parents || !depths || !cells || !actors || !dirty || !moving || !moving_list)
+    {
+        return BVR_FALSE;
     }
+
+    transforms->capacity = capacity;
+    return BVR_TRUE;
 }
 
-bvr_collider_t *bvr_register_collider(bvr_page_t *page, bvr_collider_t *collider)
+static int bvri_reserve_dirty_list(struct bvr_transform_stream_s *transforms, const uint32 count)
 {
-    BVR_ASSERT(page);
-
-    if (collider)
+    if (count <= transforms->dirty_capacity)
     {
-        bvr_collider_t **cptr = (bvr_collider_t **)bvr_pool_alloc(&page->colliders);
-        *cptr = collider;
+        return BVR_TRUE;
+    }
 
-        BVR_PRINTF("linked collider %x to the page!", *cptr);
-        return *cptr;
+    const uint32 capacity = MAX(count, MAX(transforms->dirty_capacity * 2, BVR_MAX_SCENE_ACTOR_COUNT));
+    uint32 *dirty_list = realloc(transforms->dirty_list, capacity * sizeof(uint32));
+    if (!dirty_list)
+    {
+        return BVR_FALSE;
     }
 
-    return NULL;
+    transforms->dirty_list = dirty_list;
+    transforms->dirty_capacity = capacity;
+    return BVR_TRUE;
 }
 
-struct bvr_actor_s *bvr_find_actor(bvr_book_t *book, const char *name)
+/*
+    Copy actor's transform into the streams at `index` and build its local matrix.
+*/
+static void bvri_gather_transform(struct bvr_transform_stream_s *transforms, struct bvr_actor_s *actor, const uint32 index)
 {
-    BVR_ASSERT(book);
-    BVR_ASSERT(name);
+    vec3_copy(transforms->positions[index], actor->transform.position);
+    vec3_copy(transforms->rotations[index], actor->transform.rotation);
+    vec3_copy(transforms->scales[index], actor->transform.scale);
 
-    struct bvr_actor_s *actor;
-    BVR_POOL_FOR_EACH(actor, book->page.actors)
-    {
-        if (actor == NULL)
-        {
+    mat4_compose(transforms->locals[index], 
+        transforms->positions[index], transforms->rotations[index], transforms->scales[index][0]
+    );
+}
+
+/*
+    Build world matrix at `index`, parent's world matrix must be up to date.
+*/
+static void bvri_build_world_matrix(struct bvr_transform_stream_s *transforms, const uint32 index)
+{
+    const uint32 parent = transforms->parents[index];
+
+    if (parent == BVR_INVALID_INDEX)
+    {
+        memcpy(transforms->matrices[index], transforms->locals[index], sizeof(mat4x4));
+    }
+    else
+    {
+        mat4_mul(transforms->matrices[index], transforms->matrices[parent], transforms->locals[index]);
+    }
+}
+
+/*
+    Get the key of the grid cell that contains (x, y).
+*/
+static uint64 bvri_grid_cell(const struct bvr_spatial_grid_s *grid, const float x, const float y)
+{
+    const int32 cell_x = (int32)floorf(x / grid->cell_size);
+    const int32 cell_y = (int32)floorf(y / grid->cell_size);
+
+    return ((uint64)(uint32)cell_x << 32) | (uint64)(uint32)cell_y;
+}
+
+/*
+    Insert the transform at `index` inside the cell of its world position.
+*/
+static void bvri_grid_insert(bvr_page_t *page, const uint32 index)
+{
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+
+    transforms->cells[index] = bvri_grid_cell(&page->grid, transforms->matrices[index][3][0], transforms->matrices[index][3][1]);
+    if (!bvr_hashmap_insert(&page->grid.cells, transforms->cells[index], transforms->actors[index]))
+    {
+        BVR_PRINT("failed to insert actor inside the spatial grid!");
+    }
+}
+
+/*
+    Move the transform at `index` to another cell if it left its previous one.
+*/
+static void bvri_grid_update(bvr_page_t *page, const uint32 index)
+{
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+    const uint64 cell = bvri_grid_cell(&page->grid, transforms->matrices[index][3][0], transforms->matrices[index][3][1]);
+
+    if (cell != transforms->cells[index])
+    {
+        bvr_hashmap_remove(&page->grid.cells, transforms->cells[index], transforms->actors[index]);
+        bvri_grid_insert(page, index);
+    }
+}
+
+static int bvri_push_transform(bvr_page_t *page, struct bvr_actor_s *actor)
+{
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+
+    if (!bvri_reserve_transforms(transforms, transforms->count + 1))
+    {
+        actor->transform_index = BVR_INVALID_INDEX;
+        return BVR_FALSE;
+    }
+
+    // new transforms are roots, they can be pushed after any other transform
+    actor->transform_index = transforms->count++;
+    transforms->actors[actor->transform_index] = actor;
+    transforms->parents[actor->transform_index] = BVR_INVALID_INDEX;
+    transforms->depths[actor->transform_index] = 0;
+    transforms->dirty[actor->transform_index] = 0;
+    transforms->moving[actor->transform_index] = 0;
+    bvri_gather_transform(transforms, actor, actor->transform_index);
+    bvri_build_world_matrix(transforms, actor->transform_index);
+    memcpy(transforms->previous[actor->transform_index], transforms->matrices[actor->transform_index], sizeof(mat4x4));
+    memcpy(transforms->interpolated[actor->transform_index], transforms->matrices[actor->transform_index], sizeof(mat4x4));
+    bvri_grid_insert(page, actor->transform_index);
+
+    return BVR_TRUE;
+}
+
+static void bvri_push_dirty_transform(struct bvr_transform_stream_s *transforms, const uint32 index)
+{
+    if (transforms->dirty[index])
+    {
+        return;
+    }
+
+    transforms->dirty[index] = BVRI_TRANSFORM_LOCAL;
+
+    // matrix will still be rebuilt when the actor is drawn
+    if (!bvri_reserve_dirty_list(transforms, transforms->dirty_count + 1))
+    {
+        return;
+    }
+
+    transforms->dirty_list[transforms->dirty_count++] = index;
+}
+
+static void bvri_remove_transform(bvr_page_t *page, struct bvr_actor_s *actor)
+{
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+    const uint32 index = actor->transform_index;
+
+    if (index >= transforms->count || transforms->actors[index] != actor)
+    {
+        return;
+    }
+
+    bvr_hashmap_remove(&page->grid.cells, transforms->cells[index], actor);
+
+    // move the last transform into the hole
+    const uint32 last = --transforms->count;
+
+    // moving list references indices, drop the removed transform and follow the moved one
+    for (uint32 i = 0; i < transforms->moving_count;)
+    {
+        if (transforms->moving_list[i] == index)
+        {
+            transforms->moving_list[i] = transforms->moving_list[--transforms->moving_count];
+            continue;
+        }
+
+        if (transforms->moving_list[i] == last)
+        {
+            transforms->moving_list[i] = index;
+        }
+
+        i++;
+    }
+
+    transforms->moving[index] = transforms->moving[last];
+    transforms->moving[last] = 0;
+    if (index != last)
+    {
+        vec3_copy(transforms->positions[index], transforms->positions[last]);
+        vec3_copy(transforms->rotations[index], transforms->rotations[last]);
+        vec3_copy(transforms->scales[index], transforms->scales[last]);
+        memcpy(transforms->locals[index], transforms->locals[last], sizeof(mat4x4));
+        memcpy(transforms->matrices[index], transforms->matrices[last], sizeof(mat4x4));
+        memcpy(transforms->previous[index], transforms->previous[last], sizeof(mat4x4));
+        memcpy(transforms->interpolated[index], transforms->interpolated[last], sizeof(mat4x4));
+        transforms->parents[index] = transforms->parents[last];
+        transforms->depths[index] = transforms->depths[last];
+        transforms->cells[index] = transforms->cells[last];
+
+        struct bvr_actor_s *moved = transforms->actors[last];
+        transforms->actors[index] = moved;
+        moved->transform_index = index;
+
+        // moved transform might now come before its parent
+        if (transforms->parents[index] != BVR_INVALID_INDEX && transforms->parents[index] > index)
+        {
+            transforms->unsorted = BVR_TRUE;
+        }
+
+        for (struct bvr_actor_s *child = moved->first_child; child; child = child->next_sibling)
+        {
+            transforms->parents[child->transform_index] = index;
+            if (child->transform_index < index)
+            {
+                transforms->unsorted = BVR_TRUE;
+            }
+        }
+
+        // dirty list still references the last index, which is skipped from now
+        transforms->dirty[index] = 0;
+        if (transforms->dirty[last])
+        {
+            bvri_push_dirty_transform(transforms, index);
+        }
+    }
+
+    actor->transform_index = BVR_INVALID_INDEX;
+}
+
+/*
+    Move `stream`'s elements to their new index.
+*/
+static void bvri_permute_stream(void *stream, void *scratch, const uint32 *remap, const uint32 count, const size_t size)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        memcpy((char *)scratch + remap[i] * size, (char *)stream + i * size, size);
+    }
+
+    memcpy(stream, scratch, count * size);
+}
+
+/*
+    Sort the streams by depth, so that parents always come before their children.
+*/
+static void bvri_sort_transforms(struct bvr_transform_stream_s *transforms)
+{
+    const uint32 count = transforms->count;
+
+    uint16 max_depth = 0;
+    for (uint32 i = 0; i < count; i++)
+    {
+        max_depth = MAX(max_depth, transforms->depths[i]);
+    }
+
+    uint32 *offsets = calloc(max_depth + 2, sizeof(uint32));
+    uint32 *remap = malloc(count * sizeof(uint32));
+    void *scratch = malloc(count * sizeof(mat4x4));
+
+    if (!offsets || !remap || !scratch)
+    {
+        BVR_PRINT("failed to sort transform streams!");
+
+        free(offsets);
+        free(remap);
+        free(scratch);
+        return;
+    }
+
+    // counting sort, siblings keep their order
+    for (uint32 i = 0; i < count; i++)
+    {
+        offsets[transforms->depths[i] + 1]++;
+    }
+
+    for (uint32 depth = 1; depth <= max_depth; depth++)
+    {
+        offsets[depth] += offsets[depth - 1];
+    }
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        remap[i] = offsets[transforms->depths[i]]++;
+    }
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        if (transforms->parents[i] != BVR_INVALID_INDEX)
+        {
+            transforms->parents[i] = remap[transforms->parents[i]];
+        }
+    }
+
+    bvri_permute_stream(transforms->positions, scratch, remap, count, sizeof(vec3));
+    bvri_permute_stream(transforms->rotations, scratch, remap, count, sizeof(vec3));
+    bvri_permute_stream(transforms->scales, scratch, remap, count, sizeof(vec3));
+    bvri_permute_stream(transforms->locals, scratch, remap, count, sizeof(mat4x4));
+    bvri_permute_stream(transforms->matrices, scratch, remap, count, sizeof(mat4x4));
+    bvri_permute_stream(transforms->previous, scratch, remap, count, sizeof(mat4x4));
+    bvri_permute_stream(transforms->interpolated, scratch, remap, count, sizeof(mat4x4));
+    bvri_permute_stream(transforms->parents, scratch, remap, count, sizeof(uint32));
+    bvri_permute_stream(transforms->depths, scratch, remap, count, sizeof(uint16));
+    bvri_permute_stream(transforms->cells, scratch, remap, count, sizeof(uint64));
+    bvri_permute_stream(transforms->actors, scratch, remap, count, sizeof(struct bvr_actor_s *));
+    bvri_permute_stream(transforms->dirty, scratch, remap, count, sizeof(uint8));
+    bvri_permute_stream(transforms->moving, scratch, remap, count, sizeof(uint8));
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        transforms->actors[i]->transform_index = i;
+    }
+
+    // drop removed transforms from the dirty list
+    uint32 dirty_count = 0;
+    for (uint32 i = 0; i < transforms->dirty_count; i++)
+    {
+        if (transforms->dirty_list[i] < count)
+        {
+            transforms->dirty_list[dirty_count++] = remap[transforms->dirty_list[i]];
+        }
+    }
+
+    transforms->dirty_count = dirty_count;
+    transforms->unsorted = BVR_FALSE;
+
+    // moving transforms keep being interpolated from their new index
+    for (uint32 i = 0; i < transforms->moving_count; i++)
+    {
+        transforms->moving_list[i] = remap[transforms->moving_list[i]];
+    }
+
+    free(offsets);
+    free(remap);
+    free(scratch);
+}
+
+/*
+    Set the depth of actor's subtree.
+*/
+static void bvri_set_transform_depth(struct bvr_transform_stream_s *transforms, struct bvr_actor_s *actor, const uint16 depth)
+{
+    transforms->depths[actor->transform_index] = depth;
+
+    for (struct bvr_actor_s *child = actor->first_child; child; child = child->next_sibling)
+    {
+        bvri_set_transform_depth(transforms, child, depth + 1);
+    }
+}
+
+/*
+    Get actor's index inside page's transform streams.
+    Returns BVR_INVALID_INDEX if the actor does not belong to the page.
+*/
+static uint32 bvri_transform_index(struct bvr_transform_stream_s *transforms, struct bvr_actor_s *actor)
+{
+    const uint32 index = actor->transform_index;
+
+    if (index < transforms->count && transforms->actors[index] == actor)
+    {
+        return index;
+    }
+
+    return BVR_INVALID_INDEX;
+}
+
+static int bvri_compare_transform_indices(const void *a, const void *b)
+{
+    const uint32 ia = *(const uint32 *)a;
+    const uint32 ib = *(const uint32 *)b;
+
+    return (ia > ib) - (ia < ib);
+}
+
+/*
+    Rebuild local matrices of dirty list's entries [begin, end[,
+    this function only reads and writes the streams.
+*/
+static void bvri_compose_transforms(void *data, uint32 begin, uint32 end)
+{
+    struct bvr_transform_stream_s *transforms = (struct bvr_transform_stream_s *)data;
+
+    vec3 *restrict positions = transforms->positions;
+    vec3 *restrict rotations = transforms->rotations;
+    vec3 *restrict scales = transforms->scales;
+    mat4x4 *restrict locals = transforms->locals;
+    const uint8 *restrict dirty = transforms->dirty;
+    const uint32 *restrict changed = transforms->dirty_list;
+
+    for (uint32 i = begin; i < end; i++)
+    {
+        const uint32 index = changed[i];
+        if (dirty[index] & BVRI_TRANSFORM_LOCAL)
+        {
+            mat4_compose(locals[index], positions[index], rotations[index], scales[index][0]);
+        }
+    }
+}
+
+/*
+    Moving transforms come to rest, their previous and interpolated matrices become their current one.
+*/
+static void bvri_settle_transforms(struct bvr_transform_stream_s *transforms)
+{
+    for (uint32 i = 0; i < transforms->moving_count; i++)
+    {
+        const uint32 index = transforms->moving_list[i];
+
+        memcpy(transforms->previous[index], transforms->matrices[index], sizeof(mat4x4));
+        memcpy(transforms->interpolated[index], transforms->matrices[index], sizeof(mat4x4));
+        transforms->moving[index] = 0;
+    }
+
+    transforms->moving_count = 0;
+}
+
+/*
+    Blend previous and current world matrices of moving transforms.
+*/
+static void bvri_interpolate_transforms(struct bvr_transform_stream_s *transforms, const float alpha)
+{
+    for (uint32 i = 0; i < transforms->moving_count; i++)
+    {
+        const uint32 index = transforms->moving_list[i];
+
+        const float *previous = &transforms->previous[index][0][0];
+        const float *current = &transforms->matrices[index][0][0];
+        float *interpolated = &transforms->interpolated[index][0][0];
+
+        for (uint32 j = 0; j < 16; j++)
+        {
+            interpolated[j] = previous[j] + (current[j] - previous[j]) * alpha;
+        }
+    }
+}
+
+void bvr_page_update_transforms(bvr_page_t *page)
+{
+    BVR_ASSERT(page);
+
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+    uint32 dirty_count = 0;
+
+    if (transforms->unsorted)
+    {
+        bvri_sort_transforms(transforms);
+    }
+
+    // keep each dirty transform once, untouched actors are never visited
+    for (uint32 i = 0; i < transforms->dirty_count; i++)
+    {
+        const uint32 index = transforms->dirty_list[i];
+
+        // transform has been removed or is already queued
+        if (index >= transforms->count || !transforms->dirty[index] || (transforms->dirty[index] & BVRI_TRANSFORM_WORLD))
+        {
+            continue;
+        }
+
+        transforms->dirty[index] |= BVRI_TRANSFORM_WORLD;
+        transforms->dirty_list[dirty_count++] = index;
+    }
+
+    // queue the children of dirty transforms, only dirty subtrees are visited
+    for (uint32 i = 0; i < dirty_count; i++)
+    {
+        struct bvr_actor_s *child = transforms->actors[transforms->dirty_list[i]]->first_child;
+        for (; child; child = child->next_sibling)
+        {
+            const uint32 index = child->transform_index;
+            if (transforms->dirty[index] & BVRI_TRANSFORM_WORLD)
+            {
+                continue;
+            }
+
+            if (!bvri_reserve_dirty_list(transforms, dirty_count + 1))
+            {
+                BVR_PRINT("failed to propagate transforms!");
+                break;
+            }
+
+            transforms->dirty[index] |= BVRI_TRANSFORM_WORLD;
+            transforms->dirty_list[dirty_count++] = index;
+        }
+    }
+
+    // parents come before their children inside the streams, so matrices are built in storage order.
+    // when most of the page has moved, scanning the flags is cheaper than sorting the list.
+    if (dirty_count * 4 > transforms->count)
+    {
+        dirty_count = 0;
+        for (uint32 i = 0; i < transforms->count; i++)
+        {
+            if (transforms->dirty[i] & BVRI_TRANSFORM_WORLD)
+            {
+                transforms->dirty_list[dirty_count++] = i;
+            }
+        }
+    }
+    else
+    {
+        qsort(transforms->dirty_list, dirty_count, sizeof(uint32), bvri_compare_transform_indices);
+    }
+
+    // gather modified transforms
+    for (uint32 i = 0; i < dirty_count; i++)
+    {
+        const uint32 index = transforms->dirty_list[i];
+        if (transforms->dirty[index] & BVRI_TRANSFORM_LOCAL)
+        {
+            struct bvr_actor_s *actor = transforms->actors[index];
+            vec3_copy(transforms->positions[index], actor->transform.position);
+            vec3_copy(transforms->rotations[index], actor->transform.rotation);
+            vec3_copy(transforms->scales[index], actor->transform.scale);
+        }
+    }
+
+    // rebuild local matrices, each entry is independent so batches run on worker threads
+    bvr_parallel_for(&__s_book_instance->jobs, dirty_count, BVR_TRANSFORM_BATCH_SIZE, bvri_compose_transforms, transforms);
+
+    const uint32 *changed = transforms->dirty_list;
+
+    // propagate world matrices in a single linear pass
+    for (uint32 i = 0; i < dirty_count; i++)
+    {
+        const uint32 index = changed[i];
+
+        bvri_build_world_matrix(transforms, index);
+        transforms->dirty[index] = 0;
+    }
+
+    // move actors that changed of cell
+    for (uint32 i = 0; i < dirty_count; i++)
+    {
+        bvri_grid_update(page, changed[i]);
+    }
+
+    // remember moved transforms, they are interpolated until the next tick
+    for (uint32 i = 0; i < dirty_count; i++)
+    {
+        const uint32 index = changed[i];
+        if (!transforms->moving[index])
+        {
+            transforms->moving[index] = 1;
+            transforms->moving_list[transforms->moving_count++] = index;
+        }
+    }
+
+    transforms->dirty_count = 0;
+}
+
+/*
+    Returns BVR_TRUE if actor or one of its parents has moved since the last batch.
+*/
+static int bvri_is_transform_dirty(struct bvr_transform_stream_s *transforms, struct bvr_actor_s *actor)
+{
+    for (; actor; actor = actor->parent)
+    {
+        if (transforms->dirty[actor->transform_index])
+        {
+            return BVR_TRUE;
+        }
+    }
+
+    return BVR_FALSE;
+}
+
+vec4 *bvr_get_actor_matrix(struct bvr_actor_s *actor)
+{
+    BVR_ASSERT(actor);
+
+    struct bvr_transform_stream_s *transforms = &__s_book_instance->page.transforms;
+    const uint32 index = bvri_transform_index(transforms, actor);
+
+    if (index != BVR_INVALID_INDEX)
+    {
+        // parallel callbacks must not read other transforms nor write shared matrices,
+        // they get the matrix built by the last batch.
+        if (transforms->deferred)
+        {
+            return transforms->matrices[index];
+        }
+
+        // actor has moved since the last batch (inside a callback).
+        // flags are kept, so that the next batch also updates actor's children.
+        if (bvri_is_transform_dirty(transforms, actor))
+        {
+            if (actor->parent)
+            {
+                bvr_get_actor_matrix(actor->parent);
+            }
+
+            bvri_gather_transform(transforms, actor, index);
+            bvri_build_world_matrix(transforms, index);
+        }
+
+        return transforms->matrices[index];
+    }
+
+    // actor does not belong to the current page
+    mat4_compose(actor->transform.matrix, actor->transform.position, actor->transform.rotation, actor->transform.scale[0]);
+    return actor->transform.matrix;
+}
+
+vec4 *bvr_get_actor_render_matrix(struct bvr_actor_s *actor)
+{
+    BVR_ASSERT(actor);
+
+    struct bvr_transform_stream_s *transforms = &__s_book_instance->page.transforms;
+    const uint32 index = bvri_transform_index(transforms, actor);
+
+    // actors moved since the last update are drawn where they are
+    if (index == BVR_INVALID_INDEX || bvri_is_transform_dirty(transforms, actor))
+    {
+        return bvr_get_actor_matrix(actor);
+    }
+
+    return transforms->interpolated[index];
+}
+
+void bvr_set_actor_dirty(struct bvr_actor_s *actor)
+{
+    BVR_ASSERT(actor);
+
+    struct bvr_transform_stream_s *transforms = &__s_book_instance->page.transforms;
+    const uint32 index = bvri_transform_index(transforms, actor);
+    if (index == BVR_INVALID_INDEX)
+    {
+        return;
+    }
+
+    // called from a parallel callback, the dirty list is filled once callbacks are done
+    if (transforms->deferred)
+    {
+        transforms->dirty[index] |= BVRI_TRANSFORM_DEFERRED;
+        return;
+    }
+
+    bvri_push_dirty_transform(transforms, index);
+}
+
+/*
+    Call the callbacks of `actors` [begin, end[.
+*/
+static void bvri_call_actors(void *data, uint32 begin, uint32 end)
+{
+    struct bvr_actor_s **actors = (struct bvr_actor_s **)data;
+
+    for (uint32 i = begin; i < end; i++)
+    {
+        actors[i]->callback(actors[i]);
+    }
+}
+
+void bvr_update_actors(bvr_book_t *book)
+{
+    BVR_ASSERT(book);
+
+    bvr_page_t *page = &book->page;
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+    struct bvr_actor_s *actor = NULL;
+
+    if (!page->is_available)
+    {
+        return;
+    }
+
+    struct bvr_actor_s **actors = bvr_frame_alloc(page->actors.count * sizeof(struct bvr_actor_s *));
+    if (!actors)
+    {
+        BVR_PRINT("failed to allocate callback list!");
+        return;
+    }
+
+    uint32 parallel_count = 0;
+    BVR_SLOTMAP_FOR_EACH(actor, page->actors)
+    {
+        if (actor->active && actor->callback && BVR_HAS_FLAG(actor->flags, BVR_ACTOR_PARALLEL_CALLBACK))
+        {
+            actors[parallel_count++] = actor;
+        }
+    }
+
+    // parallel callbacks only touch their own actor
+    transforms->deferred = true;
+    bvr_parallel_for(&book->jobs, parallel_count, BVR_ACTOR_CALLBACK_BATCH_SIZE, bvri_call_actors, actors);
+    transforms->deferred = false;
+
+    // queue transforms modified by parallel callbacks
+    for (uint32 i = 0; i < parallel_count; i++)
+    {
+        const uint32 index = bvri_transform_index(transforms, actors[i]);
+        if (index != BVR_INVALID_INDEX && (transforms->dirty[index] & BVRI_TRANSFORM_DEFERRED))
+        {
+            transforms->dirty[index] &= ~BVRI_TRANSFORM_DEFERRED;
+            bvri_push_dirty_transform(transforms, index);
+        }
+    }
+
+    // callbacks with shared access run serially, they might create or free actors.
+    // freeing moves another actor inside the freed slot, so actors are called through a snapshot of their handles.
+    bvr_handle_t *handles = bvr_frame_alloc(page->actors.count * sizeof(bvr_handle_t));
+    if (!handles)
+    {
+        BVR_PRINT("failed to allocate callback list!");
+        return;
+    }
+
+    uint32 serial_count = 0;
+    BVR_SLOTMAP_FOR_EACH(actor, page->actors)
+    {
+        if (actor->callback && !BVR_HAS_FLAG(actor->flags, BVR_ACTOR_PARALLEL_CALLBACK))
+        {
+            handles[serial_count++] = actor->handle;
+        }
+    }
+
+    for (uint32 i = 0; i < serial_count; i++)
+    {
+        // actor might have been freed by a previous callback
+        actor = bvr_get_actor(page, handles[i]);
+        if (actor && actor->active)
+        {
+            BVR_CALL(actor->callback, actor);
+        }
+    }
+}
+
+/*
+    Link actor to `parent` inside page's hierarchy and transform streams.
+*/
+static int bvri_set_actor_parent(bvr_page_t *page, struct bvr_actor_s *actor, struct bvr_actor_s *parent)
+{
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+    const uint32 index = bvri_transform_index(transforms, actor);
+    uint32 parent_index = BVR_INVALID_INDEX;
+
+    if (index == BVR_INVALID_INDEX)
+    {
+        BVR_PRINT("actor does not belong to this page!");
+        return BVR_FALSE;
+    }
+
+    if (actor->parent == parent)
+    {
+        return BVR_TRUE;
+    }
+
+    if (parent)
+    {
+        parent_index = bvri_transform_index(transforms, parent);
+        if (parent_index == BVR_INVALID_INDEX)
+        {
+            BVR_PRINT("parent does not belong to this page!");
+            return BVR_FALSE;
+        }
+
+        for (struct bvr_actor_s *ancestor = parent; ancestor; ancestor = ancestor->parent)
+        {
+            if (ancestor == actor)
+            {
+                BVR_PRINT("cannot attach an actor to one of its children!");
+                return BVR_FALSE;
+            }
+        }
+    }
+
+    // unlink actor from its previous parent
+    if (actor->parent)
+    {
+        struct bvr_actor_s **link = &actor->parent->first_child;
+        while (*link != actor)
+        {
+            link = &(*link)->next_sibling;
+        }
+
+        *link = actor->next_sibling;
+    }
+
+    actor->parent = parent;
+    actor->next_sibling = NULL;
+
+    if (parent)
+    {
+        actor->next_sibling = parent->first_child;
+        parent->first_child = actor;
+    }
+
+    transforms->parents[index] = parent_index;
+    bvri_set_transform_depth(transforms, actor, parent ? transforms->depths[parent_index] + 1 : 0);
+
+    if (parent_index != BVR_INVALID_INDEX && parent_index > index)
+    {
+        transforms->unsorted = BVR_TRUE;
+    }
+
+    bvri_push_dirty_transform(transforms, index);
+    return BVR_TRUE;
+}
+
+int bvr_set_actor_parent(struct bvr_actor_s *actor, struct bvr_actor_s *parent)
+{
+    BVR_ASSERT(actor);
+
+    return bvri_set_actor_parent(&__s_book_instance->page, actor, parent);
+}
+
+void bvr_set_actor_position(struct bvr_actor_s *actor, vec3 const position)
+{
+    BVR_ASSERT(actor);
+
+    vec3_copy(actor->transform.position, position);
+    bvr_set_actor_dirty(actor);
+}
+
+void bvr_set_actor_rotation(struct bvr_actor_s *actor, vec3 const rotation)
+{
+    BVR_ASSERT(actor);
+
+    vec3_copy(actor->transform.rotation, rotation);
+    bvr_set_actor_dirty(actor);
+}
+
+void bvr_set_actor_scale(struct bvr_actor_s *actor, const float scale)
+{
+    BVR_ASSERT(actor);
+
+    BVR_SCALE_VEC3(actor->transform.scale, scale);
+    bvr_set_actor_dirty(actor);
+}
+
+void bvr_translate_actor(struct bvr_actor_s *actor, vec3 const offset)
+{
+    BVR_ASSERT(actor);
+
+    vec3_add(actor->transform.position, actor->transform.position, offset);
+    bvr_set_actor_dirty(actor);
+}
+
+struct bvr_actor_s *bvr_alloc_actor(bvr_page_t *page, bvr_actor_type_t type)
+{
+    BVR_ASSERT(page);
+
+    struct bvr_actor_s** pp_actor;
+    bvr_handle_t handle;
+    const size_t actor_byte_size = bvri_actor_size(type);
+
+    // check if this actor can be added
+    if(actor_byte_size == 0){
+        BVR_PRINT("failed to allocate a new actor :<");
+        return NULL;
+    }
+
+    // get actor's slot pointer
+    pp_actor = (struct bvr_actor_s **)bvr_slotmap_alloc(&page->actors, &handle);
+    if(!pp_actor){
+        BVR_PRINT("failed to allocate a new actor, page cannot grow!");
+        return NULL;
+    }
+
+    // reuse a freed actor of the same type
+    if(page->heap.free_lists[type]){
+        *pp_actor = (struct bvr_actor_s *)page->heap.free_lists[type];
+        page->heap.free_lists[type] = *(void **)page->heap.free_lists[type];
+
+        memset(*pp_actor, 0, actor_byte_size);
+    }
+    else {
+        // garbage stream's blocks are zeroed and never move
+        *pp_actor = (struct bvr_actor_s *)bvr_memstream_alloc(
+            &__s_book_instance->garbage_stream,
+            actor_byte_size,
+            bvri_actor_alignment(type)
+        );
+
+        if(!*pp_actor){
+            bvr_slotmap_free(&page->actors, handle);
+            BVR_PRINT("failed to allocate a new actor, garbage stream cannot grow!");
+            return NULL;
+        }
+
+        page->heap.sizes[type] += actor_byte_size;
+    }
+
+    page->heap.counts[type]++;
+
+    BVR_PRINTF("alloacted a new actor (%x) remains %i bytes", 
+        *pp_actor, __s_book_instance->garbage_stream.size - __s_book_instance->garbage_stream.length
+    );
+
+    (*pp_actor)->type = type;
+    (*pp_actor)->flags = 0;
+    (*pp_actor)->order_in_layer = 0;
+    (*pp_actor)->active = true;
+    (*pp_actor)->callback = NULL;
+    (*pp_actor)->receive = NULL;
+    (*pp_actor)->handle = handle;
+
+    BVR_IDENTITY_VEC3((*pp_actor)->transform.position);
+    BVR_IDENTITY_VEC3((*pp_actor)->transform.rotation);
+    BVR_SCALE_VEC3((*pp_actor)->transform.scale, 1.0f);
+    BVR_IDENTITY_MAT4((*pp_actor)->transform.matrix);
+
+    if(!bvri_push_transform(page, *pp_actor)){
+        // give actor's memory back to its free list
+        struct bvr_actor_s* actor = *pp_actor;
+        bvr_slotmap_free(&page->actors, handle);
+
+        *(void **)actor = page->heap.free_lists[type];
+        page->heap.free_lists[type] = actor;
+        page->heap.counts[type]--;
+
+        BVR_PRINT("failed to allocate actor's transform!");
+        return NULL;
+    }
+
+    // types that have colliders
+    if(type == BVR_DYNAMIC_ACTOR || type == BVR_TEXTURE_ACTOR){
+        bvr_register_collider(page, &((bvr_dynamic_actor_t*)*pp_actor)->collider);
+    }   
+
+    return *pp_actor;
+}
+
+void bvr_free_actor(bvr_page_t* page, struct bvr_actor_s* actor){
+    BVR_ASSERT(page);
+    
+    if(actor){
+        const bvr_actor_type_t type = actor->type;
+
+        // types that have colliders
+        if(actor->type == BVR_DYNAMIC_ACTOR || actor->type == BVR_TEXTURE_ACTOR){
+            bvr_unregister_collider(page, &((bvr_dynamic_actor_t*)actor)->collider);
+        }
+
+        if(!bvr_slotmap_free(&page->actors, actor->handle)){
+            BVR_PRINT("actor does not belong to this page!");
+            return;
+        }
+
+        // children become roots
+        while(actor->first_child && bvri_set_actor_parent(page, actor->first_child, NULL));
+
+        bvri_set_actor_parent(page, actor, NULL);
+
+        bvr_unindex_actor(page, actor);
+        bvr_unsubscribe_actor(page, actor, BVR_NULL_ATOM);
+        bvri_remove_transform(page, actor);
+
+        bvr_destroy_actor(actor);
+
+        // push actor's memory into its size class free list
+        *(void **)actor = page->heap.free_lists[type];
+        page->heap.free_lists[type] = actor;
+        page->heap.counts[type]--;
+    }
+}
+
+bvr_collider_t *bvr_register_collider(bvr_page_t *page, bvr_collider_t *collider)
+{
+    BVR_ASSERT(page);
+
+    if (collider)
+    {
+        bvr_collider_t **cptr = (bvr_collider_t **)bvr_slotmap_alloc(&page->colliders, &collider->handle);
+        if (!cptr)
+        {
+            BVR_PRINT("failed to link collider, page cannot grow!");
+            return NULL;
+        }
+
+        *cptr = collider;
+
+        BVR_PRINTF("linked collider %x to the page!", *cptr);
+        return *cptr;
+    }
+
+    return NULL;
+}
+
+void bvr_unregister_collider(bvr_page_t *page, bvr_collider_t *collider)
+{
+    BVR_ASSERT(page);
+
+    if (collider)
+    {
+        bvr_slotmap_free(&page->colliders, collider->handle);
+    }
+}
+
+struct bvr_actor_s *bvr_find_actor(bvr_book_t *book, const char *name)
+{
+    BVR_ASSERT(book);
+    BVR_ASSERT(name);
+
+    return bvr_find_actor_atom(book, bvr_find_atom(name));
+}
+
+struct bvr_actor_s *bvr_find_actor_atom(bvr_book_t *book, const bvr_atom_t name)
+{
+    BVR_ASSERT(book);
+
+    // string has never been interned, no actor can have this name
+    if (name == BVR_NULL_ATOM)
+    {
+        return NULL;
+    }
+
+    return bvr_hashmap_find(&book->page.index.names, name);
+}
+
+struct bvr_actor_s *bvr_get_actor(bvr_page_t *page, bvr_handle_t handle)
+{
+    BVR_ASSERT(page);
+
+    struct bvr_actor_s **pp_actor = (struct bvr_actor_s **)bvr_slotmap_get(&page->actors, handle);
+    if (pp_actor)
+    {
+        return *pp_actor;
+    }
+
+    return NULL;
+}
+
+struct bvr_actor_s *bvr_find_actor_uuid(bvr_book_t *book, bvr_uuid_t uuid)
+{
+    BVR_ASSERT(book);
+    BVR_ASSERT(uuid);
+
+    struct bvr_actor_s *actor;
+    uint32 iterator = 0;
+
+    // hashes can collide, compare the whole uuid
+    while ((actor = bvr_hashmap_next(&book->page.index.uuids, bvr_uuid_hash(uuid), &iterator)))
+    {
+        if (bvr_uuid_equals(actor->id, uuid))
+        {
+            return actor;
+        }
+    }
+
+    return NULL;
+}
+
+static int bvri_compare_actor_names(const void *a, const void *b)
+{
+    return strcmp(
+        bvr_atom_string((*(struct bvr_actor_s *const *)a)->name),
+        bvr_atom_string((*(struct bvr_actor_s *const *)b)->name)
+    );
+}
+
+static void bvri_sort_actor_index(bvr_page_t *page)
+{
+    struct bvr_actor_index_s *index = &page->index;
+
+    if (!index->sorted_dirty)
+    {
+        return;
+    }
+
+    if (index->sorted_capacity < index->names.count)
+    {
+        index->sorted_capacity = MAX(index->names.count, index->sorted_capacity * 2);
+        index->sorted = realloc(index->sorted, index->sorted_capacity * sizeof(struct bvr_actor_s *));
+        BVR_ASSERT(index->sorted);
+    }
+
+    // name index holds every named actor
+    index->sorted_count = 0;
+    for (uint32 i = 0; i < index->names.capacity; i++)
+    {
+        void *value = index->names.entries[i].value;
+        if (value && value != BVR_HASHMAP_TOMBSTONE)
+        {
+            index->sorted[index->sorted_count++] = value;
+        }
+    }
+
+    qsort(index->sorted, index->sorted_count, sizeof(struct bvr_actor_s *), bvri_compare_actor_names);
+    index->sorted_dirty = false;
+}
+
+uint32 bvr_find_actors_prefix(bvr_book_t *book, const char *prefix, struct bvr_actor_s **actors, const uint32 count)
+{
+    BVR_ASSERT(book);
+    BVR_ASSERT(prefix);
+
+    struct bvr_actor_index_s *index = &book->page.index;
+    const uint64 prefix_length = strlen(prefix);
+
+    bvri_sort_actor_index(&book->page);
+
+    // find the first name that is not lower than the prefix
+    uint32 low = 0, high = index->sorted_count;
+    while (low < high)
+    {
+        const uint32 middle = low + (high - low) / 2;
+        if (strcmp(bvr_atom_string(index->sorted[middle]->name), prefix) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    uint32 found = 0;
+    for (uint32 i = low; i < index->sorted_count; i++)
+    {
+        if (strncmp(bvr_atom_string(index->sorted[i]->name), prefix, prefix_length) != 0)
+        {
             break;
         }
 
-        if (strncmp(actor->name.string, name, actor->name.length) == 0)
+        if (actors && found < count)
         {
-            return actor;
+            actors[found] = index->sorted[i];
         }
+
+        found++;
     }
 
-    return NULL;
+    return found;
 }
 
-struct bvr_actor_s *bvr_find_actor_uuid(bvr_book_t *book, bvr_uuid_t uuid)
+uint32 bvr_find_actors_tag(bvr_book_t *book, const char *tag, struct bvr_actor_s **actors, const uint32 count)
+{
+    BVR_ASSERT(tag);
+
+    return bvr_find_actors_tag_atom(book, bvr_find_atom(tag), actors, count);
+}
+
+uint32 bvr_find_actors_tag_atom(bvr_book_t *book, const bvr_atom_t tag, struct bvr_actor_s **actors, const uint32 count)
 {
     BVR_ASSERT(book);
-    BVR_ASSERT(uuid);
+
+    if (tag == BVR_NULL_ATOM)
+    {
+        return 0;
+    }
 
     struct bvr_actor_s *actor;
-    BVR_POOL_FOR_EACH(actor, book->page.actors)
+    uint32 iterator = 0;
+    uint32 found = 0;
+
+    while ((actor = bvr_hashmap_next(&book->page.index.tags, tag, &iterator)))
     {
-        if (actor == NULL)
+        if (actors && found < count)
         {
-            break;
+            actors[found] = actor;
         }
 
-        if (bvr_uuid_equals(actor->id, uuid))
+        found++;
+    }
+
+    return found;
+}
+
+/*
+    Returns BVR_TRUE if `position` is inside the rectangle, and inside the circle when `radius` is positive.
+*/
+static int bvri_grid_match(vec4 const position, vec2 const min, vec2 const max, vec2 const center, const float radius)
+{
+    if (position[0] < min[0] || position[0] > max[0] || position[1] < min[1] || position[1] > max[1])
+    {
+        return BVR_FALSE;
+    }
+
+    if (radius > 0.0f)
+    {
+        const float x = position[0] - center[0];
+        const float y = position[1] - center[1];
+
+        return x * x + y * y <= radius * radius;
+    }
+
+    return BVR_TRUE;
+}
+
+static uint32 bvri_query_grid(bvr_page_t *page, vec2 const min, vec2 const max, vec2 const center, const float radius,
+    struct bvr_actor_s **actors, const uint32 count)
+{
+    struct bvr_transform_stream_s *transforms = &page->transforms;
+    uint32 found = 0;
+
+    const int32 min_x = (int32)floorf(min[0] / page->grid.cell_size);
+    const int32 min_y = (int32)floorf(min[1] / page->grid.cell_size);
+    const int32 max_x = (int32)floorf(max[0] / page->grid.cell_size);
+    const int32 max_y = (int32)floorf(max[1] / page->grid.cell_size);
+
+    if (max_x < min_x || max_y < min_y)
+    {
+        return 0;
+    }
+
+    // when the region covers more cells than there are actors, scanning the streams is cheaper
+    const uint64 cell_count = (uint64)(max_x - min_x + 1) * (uint64)(max_y - min_y + 1);
+    if (cell_count > transforms->count)
+    {
+        for (uint32 i = 0; i < transforms->count; i++)
         {
-            return actor;
+            if (bvri_grid_match(transforms->matrices[i][3], min, max, center, radius))
+            {
+                if (actors && found < count)
+                {
+                    actors[found] = transforms->actors[i];
+                }
+
+                found++;
+            }
+        }
+
+        return found;
+    }
+
+    for (int32 y = min_y; y <= max_y; y++)
+    {
+        for (int32 x = min_x; x <= max_x; x++)
+        {
+            const uint64 cell = ((uint64)(uint32)x << 32) | (uint64)(uint32)y;
+            struct bvr_actor_s *actor;
+            uint32 iterator = 0;
+
+            while ((actor = bvr_hashmap_next(&page->grid.cells, cell, &iterator)))
+            {
+                if (!bvri_grid_match(transforms->matrices[actor->transform_index][3], min, max, center, radius))
+                {
+                    continue;
+                }
+
+                if (actors && found < count)
+                {
+                    actors[found] = actor;
+                }
+
+                found++;
+            }
         }
     }
 
-    return NULL;
+    return found;
 }
 
-void bvr_destroy_page(bvr_page_t *page)
+uint32 bvr_find_actors_rect(bvr_book_t *book, vec2 const min, vec2 const max, struct bvr_actor_s **actors, const uint32 count)
+{
+    BVR_ASSERT(book);
+
+    return bvri_query_grid(&book->page, min, max, min, 0.0f, actors, count);
+}
+
+uint32 bvr_find_actors_radius(bvr_book_t *book, vec2 const center, const float radius, struct bvr_actor_s **actors, const uint32 count)
+{
+    BVR_ASSERT(book);
+
+    if (radius <= 0.0f)
+    {
+        return 0;
+    }
+
+    const vec2 min = {center[0] - radius, center[1] - radius};
+    const vec2 max = {center[0] + radius, center[1] + radius};
+
+    return bvri_query_grid(&book->page, min, max, center, radius, actors, count);
+}
+
+void bvr_set_grid_cell_size(bvr_page_t *page, const float cell_size)
 {
     BVR_ASSERT(page);
-    BVR_CALL(page->events.destroy, page);
+    BVR_ASSERT(cell_size > 0.0f);
 
-    struct bvr_actor_s *actor = NULL;
-    BVR_POOL_FOR_EACH(actor, page->actors)
+    page->grid.cell_size = cell_size;
+
+    bvr_hashmap_clear(&page->grid.cells);
+    for (uint32 i = 0; i < page->transforms.count; i++)
     {
-        if (!actor) {
-            break;
+        bvri_grid_insert(page, i);
+    }
+}
+
+void bvr_index_actor(bvr_page_t *page, struct bvr_actor_s *actor)
+{
+    BVR_ASSERT(page);
+    BVR_ASSERT(actor);
+
+    if (actor->name != BVR_NULL_ATOM)
+    {
+        bvr_hashmap_insert(&page->index.names, actor->name, actor);
+        page->index.sorted_dirty = true;
+    }
+
+    if (!bvr_uuid_is_null(actor->id))
+    {
+        bvr_hashmap_insert(&page->index.uuids, bvr_uuid_hash(actor->id), actor);
+    }
+
+    if (actor->tag != BVR_NULL_ATOM)
+    {
+        bvr_hashmap_insert(&page->index.tags, actor->tag, actor);
+    }
+}
+
+void bvr_unindex_actor(bvr_page_t *page, struct bvr_actor_s *actor)
+{
+    BVR_ASSERT(page);
+    BVR_ASSERT(actor);
+
+    if (actor->name != BVR_NULL_ATOM && bvr_hashmap_remove(&page->index.names, actor->name, actor))
+    {
+        page->index.sorted_dirty = true;
+    }
+
+    if (!bvr_uuid_is_null(actor->id))
+    {
+        bvr_hashmap_remove(&page->index.uuids, bvr_uuid_hash(actor->id), actor);
+    }
+
+    if (actor->tag != BVR_NULL_ATOM)
+    {
+        bvr_hashmap_remove(&page->index.tags, actor->tag, actor);
+    }
+}
+
+void bvr_rename_actor(bvr_page_t *page, struct bvr_actor_s *actor, const char *name)
+{
+    bvr_unindex_actor(page, actor);
+    actor->name = bvr_intern(name);
+    bvr_index_actor(page, actor);
+}
+
+void bvr_set_actor_tag(bvr_page_t *page, struct bvr_actor_s *actor, const char *tag)
+{
+    bvr_unindex_actor(page, actor);
+    actor->tag = bvr_intern(tag);
+    bvr_index_actor(page, actor);
+}
+
+/*
+    Fill and post a new message.
+*/
+static int bvri_post_message(bvr_page_t *page, struct bvr_actor_s *sender, bvr_handle_t target, const bvr_atom_t channel,
+                             const uint32 type, const void *payload, const uint32 size)
+{
+    BVR_ASSERT(page);
+
+    if (size > BVR_MESSAGE_PAYLOAD_SIZE)
+    {
+        BVR_PRINTF("message payload is too big (%i bytes)!", size);
+        return BVR_FALSE;
+    }
+
+    bvr_message_t *message = bvr_message_alloc(&page->mailbox.queue);
+    if (!message)
+    {
+        return BVR_FALSE;
+    }
+
+    message->type = type;
+    message->channel = channel;
+    message->target = target;
+    message->size = size;
+
+    message->sender.index = BVR_INVALID_INDEX;
+    message->sender.generation = 0;
+    if (sender)
+    {
+        message->sender = sender->handle;
+    }
+
+    if (payload && size)
+    {
+        memcpy(message->payload, payload, size);
+    }
+
+    bvr_message_post(&page->mailbox.queue, message);
+    return BVR_TRUE;
+}
+
+int bvr_send_message(bvr_page_t *page, struct bvr_actor_s *sender, bvr_handle_t target,
+                     const uint32 type, const void *payload, const uint32 size)
+{
+    return bvri_post_message(page, sender, target, BVR_NULL_ATOM, type, payload, size);
+}
+
+int bvr_broadcast_message(bvr_page_t *page, struct bvr_actor_s *sender, const bvr_atom_t channel,
+                          const uint32 type, const void *payload, const uint32 size)
+{
+    BVR_ASSERT(channel != BVR_NULL_ATOM);
+
+    bvr_handle_t target;
+    target.index = BVR_INVALID_INDEX;
+    target.generation = 0;
+
+    return bvri_post_message(page, sender, target, channel, type, payload, size);
+}
+
+/*
+    Hash map values cannot be NULL or BVR_HASHMAP_TOMBSTONE, and atoms start at 1.
+    Subscribed channels are stored with an offset.
+*/
+#define BVRI_SUBSCRIPTION_VALUE(channel) ((void *)((size_t)(channel) + 2))
+#define BVRI_SUBSCRIPTION_CHANNEL(value) ((bvr_atom_t)((size_t)(value) - 2))
+
+int bvr_subscribe_actor(bvr_page_t *page, struct bvr_actor_s *actor, const bvr_atom_t channel)
+{
+    BVR_ASSERT(page);
+    BVR_ASSERT(actor);
+    BVR_ASSERT(channel != BVR_NULL_ATOM);
+
+    struct bvr_actor_s *subscriber = NULL;
+    uint32 iterator = 0;
+
+    while ((subscriber = bvr_hashmap_next(&page->mailbox.channels, channel, &iterator)))
+    {
+        if (subscriber == actor)
+        {
+            return BVR_TRUE;
         }
+    }
 
-        // destroy actor
-        bvr_destroy_actor(actor);
+    if (!bvr_hashmap_insert(&page->mailbox.channels, channel, actor))
+    {
+        return BVR_FALSE;
     }
 
-    bvr_collider_t *collider = NULL;
-    BVR_POOL_FOR_EACH(collider, page->colliders)
+    return bvr_hashmap_insert(&page->mailbox.subscriptions, (uint64)(size_t)actor, BVRI_SUBSCRIPTION_VALUE(channel));
+}
+
+void bvr_unsubscribe_actor(bvr_page_t *page, struct bvr_actor_s *actor, const bvr_atom_t channel)
+{
+    BVR_ASSERT(page);
+    BVR_ASSERT(actor);
+
+    const uint64 key = (uint64)(size_t)actor;
+
+    if (channel != BVR_NULL_ATOM)
     {
-        if (!collider){
-            break;
+        if (bvr_hashmap_remove(&page->mailbox.subscriptions, key, BVRI_SUBSCRIPTION_VALUE(channel)))
+        {
+            bvr_hashmap_remove(&page->mailbox.channels, channel, actor);
         }
 
-        // remove collider
-        collider = NULL;
+        return;
     }
 
-    struct bvr_light_s *light = NULL;
-    BVR_POOL_FOR_EACH(light, page->lights)
+    // remove all actor's subscriptions
+    void *subscription = NULL;
+    while ((subscription = bvr_hashmap_find(&page->mailbox.subscriptions, key)))
     {
-        if (!light){
-            break;
+        bvr_hashmap_remove(&page->mailbox.channels, BVRI_SUBSCRIPTION_CHANNEL(subscription), actor);
+        bvr_hashmap_remove(&page->mailbox.subscriptions, key, subscription);
+    }
+}
+
+void bvr_dispatch_messages(bvr_page_t *page)
+{
+    BVR_ASSERT(page);
+
+    bvr_message_queue_t *queue = &page->mailbox.queue;
+    bvr_message_t *message = bvr_message_take(queue);
+
+    while (message)
+    {
+        bvr_message_t *next = bvr_message_next(queue, message);
+        struct bvr_actor_s *actor = NULL;
+
+        if (message->channel == BVR_NULL_ATOM)
+        {
+            // target might have been freed since the message was sent
+            actor = bvr_get_actor(page, message->target);
+            if (actor && actor->active)
+            {
+                BVR_CALL(actor->receive, actor, message);
+            }
+        }
+        else
+        {
+            // receivers can subscribe, unsubscribe or free actors, which changes the channel map.
+            // collect subscribers first and resolve them again before each call.
+            uint32 count = 0, iterator = 0;
+            while (bvr_hashmap_next(&page->mailbox.channels, message->channel, &iterator))
+            {
+                count++;
+            }
+
+            bvr_handle_t *receivers = bvr_frame_alloc(count * sizeof(bvr_handle_t));
+            if (!receivers)
+            {
+                BVR_PRINT("failed to allocate message receivers!");
+                count = 0;
+            }
+
+            iterator = 0;
+            for (uint32 i = 0; i < count; i++)
+            {
+                receivers[i] = ((struct bvr_actor_s *)bvr_hashmap_next(&page->mailbox.channels, message->channel, &iterator))->handle;
+            }
+
+            for (uint32 i = 0; i < count; i++)
+            {
+                actor = bvr_get_actor(page, receivers[i]);
+                if (actor && actor->active)
+                {
+                    BVR_CALL(actor->receive, actor, message);
+                }
+            }
         }
 
+        bvr_message_free(queue, message);
+        message = next;
+    }
+}
+
+void bvr_destroy_page(bvr_page_t *page)
+{
+    BVR_ASSERT(page);
+    BVR_CALL(page->events.destroy, page);
+
+    struct bvr_actor_s *actor = NULL;
+    BVR_SLOTMAP_FOR_EACH(actor, page->actors)
+    {
+        // destroy actor
+        bvr_destroy_actor(actor);
+    }
+
+    struct bvr_light_s *light = NULL;
+    BVR_SLOTMAP_FOR_EACH(light, page->lights)
+    {
         // destroy light
     }
 
@@ -514,9 +2330,39 @@ void bvr_destroy_page(bvr_page_t *page)
 
     bvr_destroy_string(&page->name);
 
-    bvr_destroy_pool(&page->actors);
-    bvr_destroy_pool(&page->colliders);
-    bvr_destroy_pool(&page->lights);
+    bvr_destroy_slotmap(&page->actors);
+    bvr_destroy_slotmap(&page->colliders);
+    bvr_destroy_slotmap(&page->lights);
+
+    bvr_destroy_hashmap(&page->grid.cells);
+    bvr_destroy_hashmap(&page->index.names);
+    bvr_destroy_hashmap(&page->index.uuids);
+    bvr_destroy_hashmap(&page->index.tags);
+    bvr_destroy_message_queue(&page->mailbox.queue);
+    bvr_destroy_hashmap(&page->mailbox.channels);
+    bvr_destroy_hashmap(&page->mailbox.subscriptions);
+    free(page->index.sorted);
+    memset(&page->index, 0, sizeof(struct bvr_actor_index_s));
+
+    free(page->transforms.positions);
+    free(page->transforms.rotations);
+    free(page->transforms.scales);
+    free(page->transforms.locals);
+    free(page->transforms.matrices);
+    free(page->transforms.previous);
+    free(page->transforms.interpolated);
+    free(page->transforms.parents);
+    free(page->transforms.depths);
+    free(page->transforms.cells);
+    free(page->transforms.actors);
+    free(page->transforms.dirty);
+    free(page->transforms.dirty_list);
+    free(page->transforms.moving);
+    free(page->transforms.moving_list);
+    memset(&page->transforms, 0, sizeof(struct bvr_transform_stream_s));
+
+    // actors memory is owned by the garbage stream
+    memset(&page->heap, 0, sizeof(struct bvr_actor_heap_s));
 
     page->is_available = false;
 }
@@ -544,4 +2390,25 @@ static size_t bvri_actor_size(bvr_actor_type_t type)
     }
 
     return 0;
+}
+
+static size_t bvri_actor_alignment(bvr_actor_type_t type)
+{
+    switch (type)
+    {
+    case BVR_EMPTY_ACTOR:
+        return __alignof__(bvr_empty_actor_t);
+    case BVR_LAYER_ACTOR:
+        return __alignof__(bvr_layer_actor_t);
+    case BVR_TEXTURE_ACTOR:
+        return __alignof__(bvr_texture_actor_t);
+    case BVR_STATIC_ACTOR:
+        return __alignof__(bvr_static_actor_t);
+    case BVR_DYNAMIC_ACTOR:
+        return __alignof__(bvr_dynamic_actor_t);
+    case BVR_LANDSCAPE_ACTOR:
+        return __alignof__(bvr_landscape_actor_t);
+    default:
+        return sizeof(void *);
+    }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <BVR/math.h>
 #include <BVR/file.h>
 #include <BVR/image.h>
+#include <BVR/graphics.h>
 
 #include <string.h>
 #include <memory.h>
@@ -11,6 +12,13 @@
 
 #define BVR_MAX_GLSL_HEADER_SIZE 100
 
+// incremented each time a uniform is set, uniforms can be set by worker threads while draw commands are recorded
+static uint64 __s_uniform_version = 0;
+
+// shader that last uploaded uniforms to each program, shader copies share their program
+static const bvr_shader_t** __s_program_owners = NULL;
+static uint32 __s_program_owner_count = 0;
+
 // vertex shader struct
 static const char* __ext_s_vdata = "struct V_DATA {\n"
 	"   vec3 position;\n"
@@ -73,6 +81,18 @@ static const char* __ext_f_layer = "L_DATA create_layer(int layer){\n"
 "    return mix(composite, vec4(blend, 1.0), alpha);\n"
 "}\n";
 
+// per-instance attributes, locations start at BVR_INSTANCE_ATTRIB_LOCATION
+static const char* __ext_v_instance = "layout(location = 4) in mat4 bvr_instance_transform;\n"
+"layout(location = 8) in vec4 bvr_instance_tint;\n"
+"layout(location = 9) in float bvr_instance_layer;\n";
+
+// per-object constants, laid out like `struct bvr_instance_s`
+static const char* __ext_s_object = "layout(std140) uniform bvr_object {\n"
+"	mat4 bvr_transform;\n"
+"	vec4 bvr_object_tint;\n"
+"	float bvr_object_layer;\n"
+"};\n";
+
 static int bvri_compile_shader(uint32* shader, bvr_string_t* const content, int type);
 static int bvri_compile_shader_raw(uint32* shader, const char* content, int type);
 static int bvri_link_shader(const uint32 program);
@@ -169,6 +189,15 @@ static int bvri_register_shader_stage(bvr_shader_t* program, bvr_shader_stage_t*
 
             bvr_string_concat(&shader_str, __ext_f_layer);
         }
+
+        if(BVR_HAS_FLAG(program->flags, BVR_SHADER_EXT_OBJECT_BUFFER)){
+            bvr_string_concat(&shader_str, __ext_s_object);
+        }
+
+        // only vertex shader reads instances
+        if(BVR_HAS_FLAG(program->flags, BVR_SHADER_EXT_INSTANCING) && type == GL_VERTEX_SHADER){
+            bvr_string_concat(&shader_str, __ext_v_instance);
+        }
     }
 #endif    
 
@@ -222,6 +251,7 @@ int bvr_create_shaderf(bvr_shader_t* shader, FILE* file, const int flags){
     shader->program = glCreateProgram();
     shader->flags = flags;
     shader->shader_count = 0;
+    shader->uploaded = 0;
 
     // by default there is:
     // - camera block
@@ -312,6 +342,21 @@ shader_ctr_bindings:
             glUniformBlockBinding(shader->program, shader->blocks[shader->block_count].location, BVR_UNIFORM_BLOCK_GLOBAL_ILLUMINATION);
         }
     }
+
+    if(BVR_HAS_FLAG(flags, BVR_SHADER_EXT_OBJECT_BUFFER)){
+        shader->block_count++;
+
+        shader->blocks[shader->block_count].type = BVR_MAT4;
+        shader->blocks[shader->block_count].count = 1;
+        shader->blocks[shader->block_count].location = glGetUniformBlockIndex(shader->program, BVR_UNIFORM_OBJECT_NAME);
+        if (shader->blocks[shader->block_count].location == -1) {
+            BVR_PRINT("cannot find object block uniform!");
+            shader->block_count--;
+        }
+        else {
+            glUniformBlockBinding(shader->program, shader->blocks[shader->block_count].location, BVR_UNIFORM_BLOCK_OBJECT);
+        }
+    }
 #endif
 
     // create transform uniform
@@ -319,10 +364,10 @@ shader_ctr_bindings:
     shader->uniforms[0].memory.data = NULL;
     shader->uniforms[0].memory.size = sizeof(mat4x4);
     shader->uniforms[0].memory.elemsize = sizeof(mat4x4);
-    shader->uniforms[0].name.string = NULL;
-    shader->uniforms[0].name.length = 0;
+    shader->uniforms[0].name = BVR_NULL_ATOM;
     shader->uniforms[0].type = BVR_MAT4;
     shader->uniforms[0].tags = BVR_UNIFORM_TRANSFORM;
+    shader->uniforms[0].version = 0;
     if (shader->blocks[0].location == -1) {
         BVR_PRINT("cannot find transform uniform!");
     }
@@ -344,6 +389,7 @@ int bvr_create_shader_raw(bvr_shader_t* shader, const char** strings, const int
 
     shader->program = glCreateProgram();
     shader->flags = flags;
+    shader->uploaded = 0;
 
     shader->shader_count = 0;
     shader->uniform_count = 1;
@@ -395,10 +441,10 @@ int bvr_create_shader_raw(bvr_shader_t* shader, const char** strings, const int
         shader->uniforms[0].memory.data = NULL;
         shader->uniforms[0].memory.size = sizeof(mat4x4);
         shader->uniforms[0].memory.elemsize = sizeof(mat4x4);
-        shader->uniforms[0].name.string = NULL;
-        shader->uniforms[0].name.length = 0;
+        shader->uniforms[0].name = BVR_NULL_ATOM;
         shader->uniforms[0].type = BVR_MAT4;
         shader->uniforms[0].tags = BVR_UNIFORM_TRANSFORM;
+        shader->uniforms[0].version = 0;
     }
     else {
         shader->uniforms[0].location = 0;
@@ -447,15 +493,16 @@ int bvr_create_shader_raw(bvr_shader_t* shader, const char** strings, const int
 
 void bvr_create_uniform_buffer(uint32* buffer, uint64 size, uint32 binding_point){
     glGenBuffers(1, buffer);
-    glBindBuffer(GL_UNIFORM_BUFFER, *buffer);
+    bvr_gl_bind_buffer(GL_UNIFORM_BUFFER, *buffer);
     glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+    // also binds the buffer to the generic binding point, unbind after it
     glBindBufferRange(GL_UNIFORM_BUFFER, binding_point, *buffer, 0, size);
+    bvr_gl_bind_buffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void bvr_enable_uniform_buffer(uint32 buffer){
-    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    bvr_gl_bind_buffer(GL_UNIFORM_BUFFER, buffer);
 }
 
 void bvr_uniform_buffer_set(uint32 offset, uint64 size, void* data){
@@ -475,6 +522,7 @@ void bvr_destroy_uniform_buffer(uint32* buffer){
         return;
     }
 
+    bvr_gl_state_forget(*buffer);
     glDeleteBuffers(1, buffer);
 }
 
@@ -508,7 +556,8 @@ bvr_shader_uniform_t* bvr_shader_register_uniform(bvr_shader_t* shader, int type
         // no need to allocate something, just avoid bad freeing
         shader->uniforms[shader->uniform_count].memory.data = NULL;
 
-        bvr_create_string(&shader->uniforms[shader->uniform_count].name, name);
+        shader->uniforms[shader->uniform_count].name = bvr_intern(name);
+        shader->uniforms[shader->uniform_count].version = 0;
 
         return &shader->uniforms[shader->uniform_count++];
     }
@@ -532,7 +581,7 @@ bvr_shader_uniform_t* bvr_shader_register_texture(bvr_shader_t* shader, int type
     bvr_shader_uniform_t* uniform = bvr_shader_register_uniform(shader, type, BVR_UNIFORM_TEXTURE, 1, name);
     if(uniform){
         // just copy texture's pointer
-        uniform->memory.data = texture;
+        bvr_shader_set_uniformi(uniform, texture);
     }
     else {
         BVR_PRINT("failed to register texture's uniform");
@@ -573,12 +622,13 @@ int bvr_shader_set_uniformi(bvr_shader_uniform_t* uniform, void* data){
     }
     
     if(data){
-        // copy raw pointer
+        // copy raw pointer, it will be uploaded by the next `bvr_shader_enable`
         uniform->memory.data = data;
+        uniform->version = __atomic_add_fetch(&__s_uniform_version, 1, __ATOMIC_RELAXED);
         return BVR_TRUE;
     }
     else {
-        BVR_PRINTF("failed to copy %s's data!", uniform->name.string);
+        BVR_PRINTF("failed to copy %s's data!", bvr_atom_string(uniform->name));
         return BVR_FALSE;
     }
 }
@@ -590,6 +640,31 @@ int bvr_shader_set_uniform(bvr_shader_t* shader, const char* name, void* data){
     return bvr_shader_set_uniformi(bvr_find_uniform(shader, name), data);
 }
 
+/*
+    Bind texture uniforms' textures, texture units are shared between programs
+    and must be bound even if the uniform did not change.
+*/
+static void bvri_bind_uniform_texture(const uint16 type, void* data){
+    switch (type)
+    {
+    case BVR_TEXTURE_2D:
+    case BVR_TEXTURE_2D_LAYER:
+        bvr_texture_enable((bvr_texture_t*)data);
+        break;
+
+    case BVR_TEXTURE_2D_ARRAY:
+        bvr_texture_enable(&((bvr_texture_atlas_t*)data)->texture);
+        break;
+
+    case BVR_TEXTURE_2D_COMPOSITE:
+        bvr_composite_prepare((bvr_composite_t*)data);
+        break;
+    
+    default:
+        break;
+    }
+}
+
 void bvr_shader_use_uniform(bvr_shader_uniform_t* uniform, void* data){
     if(!uniform) {
         return;
@@ -597,7 +672,7 @@ void bvr_shader_use_uniform(bvr_shader_uniform_t* uniform, void* data){
 
     // if uniform is not initialize
     if(uniform->location == -1){
-        BVR_PRINTF("cannot find uniform %s", uniform->name.string);
+        BVR_PRINTF("cannot find uniform %s", bvr_atom_string(uniform->name));
         return;
     }
 
@@ -636,21 +711,13 @@ void bvr_shader_use_uniform(bvr_shader_uniform_t* uniform, void* data){
         
         case BVR_TEXTURE_2D:
         case BVR_TEXTURE_2D_LAYER:
-            {
-                bvr_texture_t* texture = (bvr_texture_t*)data;
-
-                bvr_texture_enable(texture);
-                glUniform1i(uniform->location, (int)texture->unit);
-            }
+            bvri_bind_uniform_texture(uniform->type, data);
+            glUniform1i(uniform->location, (int)((bvr_texture_t*)data)->unit);
             break;
         
         case BVR_TEXTURE_2D_ARRAY:            
-            {
-                bvr_texture_atlas_t* texture = (bvr_texture_atlas_t*)data;
-
-                bvr_texture_enable(&texture->texture);
-                glUniform1i(uniform->location, (int)texture->texture.unit);
-            }
+            bvri_bind_uniform_texture(uniform->type, data);
+            glUniform1i(uniform->location, (int)((bvr_texture_atlas_t*)data)->texture.unit);
             break;
 
         case BVR_TEXTURE_2D_LAYER_STRUCT:
@@ -658,12 +725,8 @@ void bvr_shader_use_uniform(bvr_shader_uniform_t* uniform, void* data){
             break;
 
         case BVR_TEXTURE_2D_COMPOSITE:
-            {
-                bvr_composite_t* composite = (bvr_composite_t*)data;
-
-                bvr_composite_prepare(composite);
-                glUniform1i(uniform->location, (int)0);
-            }
+            bvri_bind_uniform_texture(uniform->type, data);
+            glUniform1i(uniform->location, (int)0);
 
         default:
             break;
@@ -671,18 +734,58 @@ void bvr_shader_use_uniform(bvr_shader_uniform_t* uniform, void* data){
     }
 }
 
+/*
+    Make `shader` the owner of its program's uniform values.
+    Returns BVR_FALSE if another shader uploaded values since the last upload of this shader.
+*/
+static int bvri_claim_program(const bvr_shader_t* shader){
+    if(shader->program >= __s_program_owner_count){
+        const uint32 count = MAX(shader->program + 1, __s_program_owner_count * 2);
+        const bvr_shader_t** owners = realloc(__s_program_owners, count * sizeof(bvr_shader_t*));
+        
+        if(!owners){
+            return BVR_FALSE;
+        }
+
+        memset(owners + __s_program_owner_count, 0, (count - __s_program_owner_count) * sizeof(bvr_shader_t*));
+        __s_program_owners = owners;
+        __s_program_owner_count = count;
+    }
+
+    if(__s_program_owners[shader->program] == shader){
+        return BVR_TRUE;
+    }
+
+    __s_program_owners[shader->program] = shader;
+    return BVR_FALSE;
+}
+
 void bvr_shader_enable(bvr_shader_t* shader){
-    glUseProgram(shader->program);
+    bvr_gl_use_program(shader->program);
+
+    // program holds another shader's values
+    if(!bvri_claim_program(shader)){
+        shader->uploaded = 0;
+    }
     
-    // start at one it order to omit transform uniform
-    for (uint64 uniform = 0; uniform < shader->uniform_count; uniform++)
+    // uniform values belong to the program, only upload uniforms set since the last upload
+    for (uint64 i = 0; i < shader->uniform_count; i++)
     {
-        bvr_shader_use_uniform(&shader->uniforms[uniform], NULL);
+        bvr_shader_uniform_t* uniform = &shader->uniforms[i];
+
+        if(uniform->version > shader->uploaded){
+            bvr_shader_use_uniform(uniform, NULL);
+        }
+        else if(uniform->memory.data && uniform->location != -1){
+            bvri_bind_uniform_texture(uniform->type, uniform->memory.data);
+        }
     }
+
+    shader->uploaded = __atomic_load_n(&__s_uniform_version, __ATOMIC_RELAXED);
 }
 
 void bvr_shader_disable(void){
-    glUseProgram(0);
+    bvr_gl_use_program(0);
 }
 
 void bvr_destroy_shader(bvr_shader_t* shader){
@@ -695,10 +798,15 @@ void bvr_destroy_shader(bvr_shader_t* shader){
 
     for (uint64 uniform = 0; uniform < shader->uniform_count; uniform++)
     {
-        bvr_destroy_string(&shader->uniforms[uniform].name);
+        shader->uniforms[uniform].name = BVR_NULL_ATOM;
         shader->uniforms[uniform].memory.data = NULL;
     }
 
+    if(shader->program < __s_program_owner_count && __s_program_owners[shader->program] == shader){
+        __s_program_owners[shader->program] = NULL;
+    }
+
+    bvr_gl_state_forget(shader->program);
     glDeleteProgram(shader->program);
 
     // will trigger 'invalid shader' when 
@@ -0,0 +1,253 @@
+#include <BVR/sprites.h>
+
+#include <BVR/graphics.h>
+#include <BVR/scene.h>
+
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+#include <malloc.h>
+
+#include <GLAD/glad.h>
+
+#define BVRI_SPRITE_MAP_SIZE (BVR_SPRITE_BATCH_SIZE * 4 * sizeof(struct bvr_sprite_vertex_s))
+
+static uint32 bvri_pack_color(vec4 const color){
+    uint32 packed = 0;
+
+    for (uint32 i = 0; i < 4; i++)
+    {
+        const float channel = color[i] < 0.0f ? 0.0f : (color[i] > 1.0f ? 1.0f : color[i]);
+        packed |= (uint32)(channel * 255.0f + 0.5f) << (i * 8);
+    }
+
+    return packed;
+}
+
+/*
+    Map the next range of the vertex buffer, the buffer is orphaned if the range does not fit.
+*/
+static int bvri_sprite_batch_map(bvr_sprite_batch_t* batch){
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, batch->vertex_buffer);
+
+    // pending draws keep the previous storage
+    if(batch->cursor + BVRI_SPRITE_MAP_SIZE > BVR_SPRITE_BUFFER_SIZE){
+        glBufferData(GL_ARRAY_BUFFER, BVR_SPRITE_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+        batch->cursor = 0;
+    }
+
+    // ranges are only appended, previous draws never read the mapped range
+    batch->vertices = glMapBufferRange(GL_ARRAY_BUFFER, batch->cursor, BVRI_SPRITE_MAP_SIZE,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT
+    );
+
+    if(!batch->vertices){
+        BVR_PRINT("failed to map sprite buffer!");
+        return BVR_FALSE;
+    }
+
+    return BVR_TRUE;
+}
+
+/*
+    Unmap and draw the current batch.
+*/
+static void bvri_sprite_batch_flush(bvr_sprite_batch_t* batch){
+    if(!batch->vertices){
+        return;
+    }
+
+    const uint64 size = batch->count * 4 * sizeof(struct bvr_sprite_vertex_s);
+
+    bvr_gl_bind_vertex_array(batch->array_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, batch->vertex_buffer);
+
+    if(size){
+        glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, size);
+    }
+
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    batch->vertices = NULL;
+
+    if(!batch->count){
+        return;
+    }
+
+    // there is no base vertex, attributes point at the batch instead
+    const int stride = sizeof(struct bvr_sprite_vertex_s);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)(batch->cursor + offsetof(struct bvr_sprite_vertex_s, position)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(batch->cursor + offsetof(struct bvr_sprite_vertex_s, uvs)));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(batch->cursor + offsetof(struct bvr_sprite_vertex_s, color)));
+
+    bvr_shader_t* shader = batch->shader;
+    if(!shader){
+        if(batch->texture && batch->texture->target == GL_TEXTURE_2D_ARRAY){
+            shader = &bvr_get_instance()->predefs.c_shaders.c_sprite_atlas_shader;
+        }
+        else {
+            shader = &bvr_get_instance()->predefs.c_shaders.c_sprite_shader;
+        }
+    }
+
+    bvr_shader_enable(shader);
+
+    if(batch->texture){
+        bvr_gl_active_texture(BVR_TEXTURE_UNIT0);
+        bvr_gl_bind_texture(batch->texture->target, batch->texture->id);
+    }
+
+    glDrawElements(GL_TRIANGLES, batch->count * 6, GL_UNSIGNED_SHORT, NULL);
+
+    batch->cursor += size;
+    batch->stats.batches++;
+    batch->stats.bytes += size;
+
+    struct bvr_draw_stats_s* stats = &bvr_get_instance()->pipeline.stats;
+    stats->sprites += batch->count;
+    stats->sprite_batches++;
+    stats->streamed_bytes += size;
+
+    batch->count = 0;
+}
+
+int bvr_create_sprite_batch(bvr_sprite_batch_t* batch){
+    BVR_ASSERT(batch);
+
+    memset(batch, 0, sizeof(bvr_sprite_batch_t));
+
+    uint16* indices = malloc(BVR_SPRITE_BATCH_SIZE * 6 * sizeof(uint16));
+    if(!indices){
+        BVR_PRINT("failed to allocate sprite indices!");
+        return BVR_FALSE;
+    }
+
+    // two triangles per quad
+    for (uint32 i = 0; i < BVR_SPRITE_BATCH_SIZE; i++)
+    {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 0;
+        indices[i * 6 + 4] = i * 4 + 2;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+
+    glGenVertexArrays(1, &batch->array_buffer);
+    bvr_gl_bind_vertex_array(batch->array_buffer);
+
+    glGenBuffers(1, &batch->vertex_buffer);
+    bvr_gl_bind_buffer(GL_ARRAY_BUFFER, batch->vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, BVR_SPRITE_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+
+    glGenBuffers(1, &batch->element_buffer);
+    bvr_gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, batch->element_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, BVR_SPRITE_BATCH_SIZE * 6 * sizeof(uint16), indices, GL_STATIC_DRAW);
+
+    free(indices);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+
+    return BVR_TRUE;
+}
+
+void bvr_sprite_batch_begin(bvr_sprite_batch_t* batch, bvr_shader_t* shader){
+    BVR_ASSERT(batch);
+    BVR_ASSERT(!batch->drawing);
+
+    batch->shader = shader;
+    batch->texture = NULL;
+    batch->count = 0;
+    batch->drawing = true;
+
+    memset(&batch->stats, 0, sizeof(struct bvr_sprite_stats_s));
+}
+
+void bvr_sprite_batch_push(bvr_sprite_batch_t* batch, bvr_texture_t* texture, const bvr_sprite_t* sprite){
+    BVR_ASSERT(batch);
+    BVR_ASSERT(sprite);
+    BVR_ASSERT(batch->drawing);
+
+    if(texture != batch->texture || batch->count == BVR_SPRITE_BATCH_SIZE){
+        bvri_sprite_batch_flush(batch);
+        batch->texture = texture;
+    }
+
+    if(!batch->vertices && !bvri_sprite_batch_map(batch)){
+        return;
+    }
+
+    const float hw = sprite->size[0] * 0.5f;
+    const float hh = sprite->size[1] * 0.5f;
+    const float corners[4][2] = {
+        {-hw, -hh}, { hw, -hh}, { hw,  hh}, {-hw,  hh}
+    };
+    const float uvs[4][2] = {
+        {sprite->uvs[0], sprite->uvs[1]}, {sprite->uvs[2], sprite->uvs[1]},
+        {sprite->uvs[2], sprite->uvs[3]}, {sprite->uvs[0], sprite->uvs[3]}
+    };
+
+    float c = 1.0f, s = 0.0f;
+    if(sprite->rotation != 0.0f){
+        c = cosf(sprite->rotation);
+        s = sinf(sprite->rotation);
+    }
+
+    const uint32 color = bvri_pack_color(sprite->color);
+    struct bvr_sprite_vertex_s* vertex = &batch->vertices[batch->count * 4];
+
+    for (uint32 i = 0; i < 4; i++)
+    {
+        vertex[i].position[0] = sprite->position[0] + corners[i][0] * c - corners[i][1] * s;
+        vertex[i].position[1] = sprite->position[1] + corners[i][0] * s + corners[i][1] * c;
+        vertex[i].position[2] = sprite->position[2];
+
+        vertex[i].uvs[0] = uvs[i][0];
+        vertex[i].uvs[1] = uvs[i][1];
+        vertex[i].uvs[2] = (float)sprite->layer;
+
+        vertex[i].color = color;
+    }
+
+    batch->count++;
+    batch->stats.sprites++;
+}
+
+void bvr_sprite_batch_set_shader(bvr_sprite_batch_t* batch, bvr_shader_t* shader){
+    BVR_ASSERT(batch);
+
+    if(batch->shader == shader){
+        return;
+    }
+
+    bvri_sprite_batch_flush(batch);
+    batch->shader = shader;
+}
+
+void bvr_sprite_batch_end(bvr_sprite_batch_t* batch){
+    BVR_ASSERT(batch);
+    BVR_ASSERT(batch->drawing);
+
+    bvri_sprite_batch_flush(batch);
+    batch->drawing = false;
+}
+
+void bvr_destroy_sprite_batch(bvr_sprite_batch_t* batch){
+    BVR_ASSERT(batch);
+
+    if(batch->vertices){
+        bvr_gl_bind_buffer(GL_ARRAY_BUFFER, batch->vertex_buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    bvr_gl_state_forget(batch->array_buffer);
+    bvr_gl_state_forget(batch->vertex_buffer);
+    bvr_gl_state_forget(batch->element_buffer);
+
+    glDeleteVertexArrays(1, &batch->array_buffer);
+    glDeleteBuffers(1, &batch->vertex_buffer);
+    glDeleteBuffers(1, &batch->element_buffer);
+
+    memset(batch, 0, sizeof(bvr_sprite_batch_t));
+}
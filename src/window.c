@@ -72,6 +72,9 @@ int bvr_create_window(bvr_window_t* window, const uint16 width, const uint16 hei
     BVR_ASSERT(gladLoadGLES2Loader((GLADloadproc)SDL_GL_GetProcAddress));
     BVR_PRINT(glGetString(GL_VERSION));
 
+    // the context starts with default state
+    bvr_gl_state_reset();
+
     // check for extensions
     if(!GLAD_GL_EXT_copy_image || !GLAD_GL_EXT_copy_image){
         BVR_PRINT("failed to load extentensions! some implementations might not work properly :(");